@@ -0,0 +1,79 @@
+// =================== Audio Ring Buffer Implementation ===================
+
+#include "audioring.h"
+#include <stdlib.h>
+
+// =================== AudioRing Constructor/Destructor ===================
+AudioRing::AudioRing()
+    : Buf(0), Size(0), Head(0), Tail(0)
+{
+}
+
+AudioRing::~AudioRing()
+{
+    free(Buf);
+}
+
+// =================== AudioRing::Init ===================
+sBool AudioRing::Init(sInt frames)
+{
+    sInt size = 1;
+    while (size < frames)
+        size <<= 1;
+
+    free(Buf);
+    Buf = (sF32 *)calloc(2 * size, sizeof(sF32));
+    Size = Buf ? size : 0;
+    Head = 0;
+    Tail = 0;
+    return Buf != 0;
+}
+
+// =================== AudioRing::Write ===================
+sInt AudioRing::Write(const sF32 *buf, sInt frames)
+{
+    sU64 head = Head.load(std::memory_order_relaxed);
+    sU64 tail = Tail.load(std::memory_order_acquire);
+    frames = sMin(frames, Size - sInt(head - tail));
+
+    // Copy in up to two pieces around the wrap point
+    sInt pos = sInt(head & (Size - 1));
+    sInt first = sMin(frames, Size - pos);
+    sCopyMem(Buf + 2 * pos, buf, sizeof(sF32) * 2 * first);
+    sCopyMem(Buf, buf + 2 * first, sizeof(sF32) * 2 * (frames - first));
+
+    Head.store(head + frames, std::memory_order_release);
+    return frames;
+}
+
+// =================== AudioRing::Read ===================
+sInt AudioRing::Read(sF32 *buf, sInt frames)
+{
+    sU64 tail = Tail.load(std::memory_order_relaxed);
+    sU64 head = Head.load(std::memory_order_acquire);
+    frames = sMin(frames, sInt(head - tail));
+
+    sInt pos = sInt(tail & (Size - 1));
+    sInt first = sMin(frames, Size - pos);
+    sCopyMem(buf, Buf + 2 * pos, sizeof(sF32) * 2 * first);
+    sCopyMem(buf + 2 * first, Buf, sizeof(sF32) * 2 * (frames - first));
+
+    Tail.store(tail + frames, std::memory_order_release);
+    return frames;
+}
+
+// =================== AudioRing Accessors ===================
+sInt AudioRing::GetFill() const
+{
+    return sInt(Head.load(std::memory_order_acquire) - Tail.load(std::memory_order_acquire));
+}
+
+sInt AudioRing::GetFree() const
+{
+    return Size - GetFill();
+}
+
+sInt AudioRing::GetSize() const
+{
+    return Size;
+}
@@ -0,0 +1,46 @@
+// =================== Audio Ring Buffer ===================
+// Wait-free single producer/single consumer ring of interleaved stereo
+// float frames. One thread writes, one other thread reads; neither side
+// ever blocks, allocates or takes a lock, so the reader may run inside
+// an audio driver callback.
+
+#ifndef AUDIORING_H
+#define AUDIORING_H
+
+#include <atomic>
+#include "types.h"
+
+// =================== AudioRing Class ===================
+class AudioRing
+{
+private:
+    sF32 *Buf;                             // Interleaved stereo frames
+    sInt Size;                             // Capacity in frames (power of 2)
+    std::atomic<sU64> Head;                // Frames written (producer)
+    std::atomic<sU64> Tail;                // Frames read (consumer)
+
+public:
+    AudioRing();
+    ~AudioRing();
+
+    // Allocate room for at least frames frames (rounded up to a power of 2)
+    // Not thread safe, call before producer and consumer start
+    sBool Init(sInt frames);
+
+    // Producer: copy up to frames frames in, returns frames written
+    sInt Write(const sF32 *buf, sInt frames);
+
+    // Consumer: copy up to frames frames out, returns frames read
+    sInt Read(sF32 *buf, sInt frames);
+
+    // Frames waiting to be read
+    sInt GetFill() const;
+
+    // Frames that can be written
+    sInt GetFree() const;
+
+    // Capacity in frames
+    sInt GetSize() const;
+};
+
+#endif // AUDIORING_H
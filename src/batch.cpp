@@ -0,0 +1,340 @@
+// =================== Batch Renderer Implementation ===================
+
+#include "batch.h"
+#include "module.h"
+#include "modcache.h"
+#include "threadpool.h"
+#include "wavwriter.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <strings.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+// =================== Path List ===================
+// Growable array of heap allocated path strings
+struct PathList
+{
+    char **Paths;
+    sInt Count;
+    sInt Alloc;
+};
+
+static void path_add(PathList &list, const char *path)
+{
+    if (list.Count == list.Alloc)
+    {
+        list.Alloc = sMax(64, list.Alloc * 2);
+        list.Paths = (char **)realloc(list.Paths, list.Alloc * sizeof(char *));
+    }
+    list.Paths[list.Count++] = strdup(path);
+}
+
+static int path_compare(const void *a, const void *b)
+{
+    return strcmp(*(const char **)a, *(const char **)b);
+}
+
+// Module files are named "*.mod" or Amiga style "mod.*"
+static sBool is_mod_name(const char *name)
+{
+    size_t len = strlen(name);
+    if (len > 4 && !strcasecmp(name + len - 4, ".mod"))
+        return 1;
+    return !strncasecmp(name, "mod.", 4);
+}
+
+// Collect module files below a directory
+static void scan_dir(PathList &list, const char *dir)
+{
+    DIR *d = opendir(dir);
+    if (!d)
+    {
+        perror(dir);
+        return;
+    }
+
+    struct dirent *de;
+    while ((de = readdir(d)) != NULL)
+    {
+        if (de->d_name[0] == '.')
+            continue;
+
+        char path[4096];
+        snprintf(path, sizeof(path), "%s/%s", dir, de->d_name);
+
+        struct stat sb;
+        if (stat(path, &sb) == -1)
+            continue;
+
+        if (S_ISDIR(sb.st_mode))
+            scan_dir(list, path);
+        else if (S_ISREG(sb.st_mode) && is_mod_name(de->d_name))
+            path_add(list, path);
+    }
+    closedir(d);
+}
+
+// Read one path per line, skipping blank lines and '#' comments
+static sBool read_list(PathList &list, const char *listname)
+{
+    FILE *fh = strcmp(listname, "-") ? fopen(listname, "r") : stdin;
+    if (!fh)
+    {
+        perror(listname);
+        return 0;
+    }
+
+    char line[4096];
+    while (fgets(line, sizeof(line), fh))
+    {
+        size_t len = strlen(line);
+        while (len && isspace((unsigned char)line[len - 1]))
+            line[--len] = 0;
+        if (len && line[0] != '#')
+            path_add(list, line);
+    }
+
+    if (fh != stdin)
+        fclose(fh);
+    return 1;
+}
+
+// =================== Batch Job ===================
+struct BatchJob
+{
+    const BatchOptions *Opt;               // Shared options
+    ModuleCache *Cache;                    // Shared module cache
+    const char *Path;                      // Module file
+    const char *Name;                      // Path relative to the batch source
+    char *OutName;                         // Output file (NULL = analyse only)
+    const BatchJob *Clash;                 // Earlier job writing the same output file (NULL = none)
+    sBool Ok;                              // Processed without errors
+    size_t FileSize;                       // Module size in bytes
+    RenderResult Res;                      // Render length and timing
+    sF32 Peak;                             // Peak absolute sample value
+    sF64 SumSq;                            // Sum of squared samples (for RMS)
+    sU64 Hash;                             // FNV-1a hash of the rendered samples
+    WavWriter *Wav;                        // Output writer (NULL = analyse only)
+};
+
+// Analyse each block and pass it on to the writer
+static sBool job_block(void *parm, const sF32 *buf, sInt frames)
+{
+    BatchJob *job = (BatchJob *)parm;
+
+    const sU8 *bytes = (const sU8 *)buf;
+    for (sInt i = 0; i < 2 * frames; i++)
+    {
+        sF32 v = buf[i];
+        job->Peak = sMax(job->Peak, sAbs(v));
+        job->SumSq += v * v;
+    }
+    for (size_t i = 0; i < sizeof(sF32) * 2 * frames; i++)
+        job->Hash = (job->Hash ^ bytes[i]) * 0x100000001b3ULL;
+
+    return job->Wav ? job->Wav->Write(buf, frames) : 1;
+}
+
+// Output name: module path with directory separators flattened
+static void job_outname(const BatchJob *job, char *out, size_t size)
+{
+    const char *p = job->Name;
+    while (p[0] == '.' && p[1] == '/')
+        p += 2;
+    while (*p == '/')
+        p++;
+
+    snprintf(out, size, "%s/%s.%s", job->Opt->OutDir, p, job->Opt->Render.Raw ? "raw" : "wav");
+    for (char *c = out + strlen(job->Opt->OutDir) + 1; *c; c++)
+        if (*c == '/')
+            *c = '_';
+}
+
+// Sort jobs by output name, jobs with the same name in input order
+static int job_outname_compare(const void *a, const void *b)
+{
+    const BatchJob *ja = *(const BatchJob **)a;
+    const BatchJob *jb = *(const BatchJob **)b;
+    int c = strcmp(ja->OutName, jb->OutName);
+    return c ? c : (ja < jb ? -1 : ja > jb);
+}
+
+// Name every job's output file; flattening can map different inputs
+// ("a/b.mod", "a_b.mod") or a module listed twice to the same file, so
+// all but the first job of such a group are marked to fail instead of
+// writing the file concurrently
+static void jobs_name_outputs(BatchJob *jobs, sInt count)
+{
+    BatchJob **order = (BatchJob **)malloc(sizeof(BatchJob *) * count);
+    for (sInt i = 0; i < count; i++)
+    {
+        char outname[4096];
+        job_outname(&jobs[i], outname, sizeof(outname));
+        jobs[i].OutName = strdup(outname);
+        order[i] = &jobs[i];
+    }
+
+    qsort(order, count, sizeof(BatchJob *), job_outname_compare);
+    for (sInt i = 1; i < count; i++)
+    {
+        if (!strcmp(order[i]->OutName, order[i - 1]->OutName))
+            order[i]->Clash = order[i - 1]->Clash ? order[i - 1]->Clash : order[i - 1];
+    }
+    free(order);
+}
+
+// Pool task: load, render/analyse and release one module
+static void job_run(void *parm, sInt worker)
+{
+    BatchJob *job = (BatchJob *)parm;
+    (void)worker;
+
+    job->Peak = 0;
+    job->SumSq = 0;
+    job->Hash = 0xcbf29ce484222325ULL;
+    job->Wav = NULL;
+
+    if (job->Clash)
+    {
+        fprintf(stderr, "Error: %s would overwrite the output of %s (%s)\n", job->Path, job->Clash->Path,
+                job->OutName);
+        return;
+    }
+
+    const Module *mod = job->Cache->Load(job->Path);
+    if (!mod)
+        return;
+    job->FileSize = mod->GetSize();
+
+    FILE *out = NULL;
+    WavWriter wav;
+    if (job->OutName)
+    {
+        out = fopen(job->OutName, "wb");
+        if (!out || !wav.Open(out, job->Opt->Render.Format, 2, OUTRATE, job->Opt->Render.Raw))
+        {
+            perror(job->OutName);
+            if (out)
+                fclose(out);
+            mod->Release();
+            return;
+        }
+        wav.SetDither(job->Opt->Render.Dither);
+        job->Wav = &wav;
+    }
+
+    job->Ok = render_module(mod, job->Opt->Render, job_block, job, job->Res);
+
+    if (out)
+    {
+        if (!wav.Close())
+            job->Ok = 0;
+        if (fclose(out) != 0)
+            job->Ok = 0;
+    }
+    mod->Release();
+}
+
+// =================== batch_run ===================
+int batch_run(const char *source, const BatchOptions &opt)
+{
+    // === Collect Module Files ===
+    PathList list = { NULL, 0, 0 };
+    size_t skip = 0;
+    struct stat sb;
+    if (stat(source, &sb) == 0 && S_ISDIR(sb.st_mode))
+    {
+        skip = strlen(source) + 1;
+        scan_dir(list, source);
+        qsort(list.Paths, list.Count, sizeof(char *), path_compare);
+    }
+    else if (!read_list(list, source))
+        return 1;
+
+    if (!list.Count)
+    {
+        fprintf(stderr, "Error: No MOD files found in %s\n", source);
+        return 1;
+    }
+
+    // === Run All Jobs ===
+    BatchJob *jobs = (BatchJob *)calloc(list.Count, sizeof(BatchJob));
+    ThreadPool pool(opt.Jobs);
+    ThreadPool::Group group;
+    ModuleCache cache(opt.CacheBytes);
+
+    fprintf(stderr, "Processing %d modules on %d threads...\n", list.Count, pool.GetThreadCount());
+    sF64 start = sGetTime();
+
+    for (sInt i = 0; i < list.Count; i++)
+    {
+        jobs[i].Opt = &opt;
+        jobs[i].Cache = &cache;
+        jobs[i].Path = list.Paths[i];
+        jobs[i].Name = list.Paths[i] + skip;
+    }
+    if (opt.OutDir)
+        jobs_name_outputs(jobs, list.Count);
+
+    for (sInt i = 0; i < list.Count; i++)
+        pool.Submit(job_run, &jobs[i], &group);
+    pool.Wait(group);
+
+    sF64 wall = sGetTime() - start;
+
+    // === Per-Module Results (input order) ===
+    sInt failed = 0;
+    sU64 frames = 0;
+    sU64 bytes = 0;
+    sF64 cpu = 0;
+    for (sInt i = 0; i < list.Count; i++)
+    {
+        const BatchJob &job = jobs[i];
+        if (!job.Ok)
+        {
+            printf("FAIL  %s\n", job.Path);
+            failed++;
+            continue;
+        }
+
+        sF64 rms = job.Res.Frames ? sqrt(job.SumSq / (2.0 * job.Res.Frames)) : 0;
+        printf("OK    %8.2fs  peak %.4f  rms %.4f  %016llx  %s\n",
+               sF64(job.Res.Frames) / OUTRATE, job.Peak, rms, (unsigned long long)job.Hash, job.Path);
+
+        frames += job.Res.Frames;
+        bytes += job.FileSize;
+        cpu += job.Res.Seconds;
+    }
+
+    // === Aggregate Statistics ===
+    sF64 audio = sF64(frames) / OUTRATE;
+    printf("\nModules:    %d ok, %d failed\n", list.Count - failed, failed);
+    printf("Audio:      %.1f seconds rendered in %.2f seconds (%.1fx realtime)\n",
+           audio, wall, wall > 0 ? audio / wall : 0.0);
+    printf("CPU time:   %.2f seconds (%.1fx realtime per thread)\n", cpu, cpu > 0 ? audio / cpu : 0.0);
+    printf("Throughput: %.2f modules/s, %.2f MB/s of module data\n",
+           wall > 0 ? (list.Count - failed) / wall : 0.0, wall > 0 ? bytes / wall / 1048576.0 : 0.0);
+    ModuleCacheStats cs;
+    cache.GetStats(cs);
+    printf("Cache:      %llu hits, %llu misses, %llu evictions, %d modules in %.1f of %.1f MB\n",
+           (unsigned long long)cs.Hits, (unsigned long long)cs.Misses, (unsigned long long)cs.Evictions,
+           cs.Modules, cs.Bytes / 1048576.0, cs.Budget / 1048576.0);
+    for (sInt i = 0; i < pool.GetThreadCount(); i++)
+    {
+        const ThreadPool::WorkerStats &ws = pool.GetStats(i);
+        printf("Worker %2d:  %llu jobs, %llu stolen\n", i, (unsigned long long)ws.Tasks,
+               (unsigned long long)ws.Steals);
+    }
+
+    for (sInt i = 0; i < list.Count; i++)
+    {
+        free(list.Paths[i]);
+        free(jobs[i].OutName);
+    }
+    free(list.Paths);
+    free(jobs);
+
+    return failed ? 1 : 0;
+}
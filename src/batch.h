@@ -0,0 +1,27 @@
+// =================== Batch Renderer ===================
+// Renders or analyses many MOD files concurrently on a thread pool
+// Each module gets its own ModPlayer/Paula pair, results are reported
+// in input order so the output does not depend on scheduling
+// Modules are loaded through a shared cache, so a file listed several
+// times (or the same file under different names) is parsed only once
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "types.h"
+#include "render.h"
+
+// =================== Batch Options ===================
+struct BatchOptions
+{
+    RenderOptions Render;                  // Per-module render settings
+    const char *OutDir;                    // Output directory (NULL = analyse only)
+    sInt Jobs;                             // Worker threads (0 = one per CPU core)
+    size_t CacheBytes;                     // Parsed module cache budget (0 = no caching)
+};
+
+// Process a directory (recursively) or a file list ('-' = stdin)
+// Returns 0 if every module was processed successfully
+int batch_run(const char *source, const BatchOptions &opt);
+
+#endif // BATCH_H
@@ -0,0 +1,546 @@
+// =================== TinyMOD Benchmarks ===================
+// Microbenchmarks for each stage of the render path (voice generation,
+// CalcFrag, the FIR, the sequencer, pattern parsing) plus end-to-end
+// renders of real modules and of a generated worst-case module. Every
+// result is reported per unit of work as ns, multiple of realtime and CPU
+// cycles, as a table or as JSON (--json) that can be stored and compared
+// to catch regressions.
+// With --verify the tool checks the output of every render engine
+// against the reference path and the stored golden hashes instead.
+//
+// Build with "make bench", run from the source directory:
+//   ./tinymod_bench [--json] [--time <seconds>] [--filter <text>] [mod files...]
+//   ./tinymod_bench --verify [--seconds <n>] [--golden <file>] [--update-golden] [mod files...]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_TSC
+#endif
+
+#include "types.h"
+#include "config.h"
+#include "paula.h"
+#include "modplayer.h"
+#include "module.h"
+#include "modfile.h"
+#include "modgen.h"
+#include "verify.h"
+
+// =================== Configuration ===================
+static const sInt BENCH_MIN_RUNS = 3;      // Timed runs per benchmark at least
+static const sInt BENCH_MAX_RESULTS = 64;  // Results collected per invocation
+static const sInt VERIFY_SECONDS = 10;     // Default verified excerpt length
+static const sInt TICK_FRAMES = (125 * OUTRATE) / (125 * OUTFPS);  // Frames per tick at 125 BPM
+
+// =================== Timing ===================
+
+// CPU time stamp counter (0 where there is none)
+// Note: modern x86 CPUs count at a constant reference rate, which can
+// differ from the actual core clock under turbo or power saving
+static inline sU64 bench_cycles()
+{
+#ifdef BENCH_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Runs the benchmarked code once and returns the units of work done
+typedef sF64 (*BenchFunc)(void *parm);
+
+// =================== Result ===================
+struct BenchResult
+{
+    char Name[64];                         // Benchmark name ("stage/variant")
+    const char *Unit;                      // Unit of work ("frame", "sample", ...)
+    sF64 UnitRate;                         // Units per second of audio (0 = not audio)
+    sF64 NsPerUnit;                        // Fastest run: wall clock ns per unit
+    sF64 CyclesPerUnit;                    // Fastest run: CPU cycles per unit
+    sInt Runs;                             // Timed runs
+};
+
+struct BenchSuite
+{
+    sF64 MinTime;                          // Keep running a benchmark for at least this long
+    const char *Filter;                    // Only run benchmarks whose name contains this
+    BenchResult Results[BENCH_MAX_RESULTS];
+    sInt Count;
+};
+
+// Run a benchmark: one untimed warm-up run, then timed runs until the
+// minimum time has passed; the fastest run counts (least disturbed)
+static void bench_run(BenchSuite &suite, const char *name, const char *unit, sF64 rate, BenchFunc func,
+                      void *parm)
+{
+    if (suite.Filter && !strstr(name, suite.Filter))
+        return;
+    if (suite.Count == BENCH_MAX_RESULTS)
+        return;
+
+    BenchResult &r = suite.Results[suite.Count++];
+    snprintf(r.Name, sizeof(r.Name), "%s", name);
+    r.Unit = unit;
+    r.UnitRate = rate;
+    r.NsPerUnit = 0;
+    r.CyclesPerUnit = 0;
+    r.Runs = 0;
+
+    func(parm);
+
+    sF64 start = sGetTime();
+    while (r.Runs < BENCH_MIN_RUNS || sGetTime() - start < suite.MinTime)
+    {
+        sF64 t0 = sGetTime();
+        sU64 c0 = bench_cycles();
+        sF64 units = func(parm);
+        sU64 c1 = bench_cycles();
+        sF64 t1 = sGetTime();
+
+        sF64 ns = (t1 - t0) * 1e9 / units;
+        if (!r.Runs || ns < r.NsPerUnit)
+        {
+            r.NsPerUnit = ns;
+            r.CyclesPerUnit = sF64(c1 - c0) / units;
+        }
+        r.Runs++;
+    }
+
+    fprintf(stderr, "  %s\n", name);
+}
+
+// Fill a buffer with deterministic noise
+static void bench_noise(sU8 *buf, sInt size, sU32 seed)
+{
+    for (sInt i = 0; i < size; i++)
+    {
+        seed = seed * 1664525 + 1013904223;
+        buf[i] = sU8(seed >> 24);
+    }
+}
+
+// =================== Voice Benchmarks ===================
+// One Paula voice rendering a looped sample for a block of Paula cycles
+
+static const sInt VOICE_SAMPLES = 0x10000;         // Paula cycles per run
+static const sInt VOICE_SAMPLE_BYTES = 1024;       // Looped sample size
+
+struct VoiceBench
+{
+    Paula::Voice V;
+    sF32 *Buf;
+};
+
+static sF64 bench_voice(void *parm)
+{
+    VoiceBench *b = (VoiceBench *)parm;
+    sZeroMem(b->Buf, sizeof(sF32) * VOICE_SAMPLES);
+    b->V.Render(b->Buf, VOICE_SAMPLES);
+    return VOICE_SAMPLES;
+}
+
+static void bench_voices(BenchSuite &suite, const sS8 *sample)
+{
+    static const sInt periods[] = { 113, 428, 1712 };   // Highest, middle and lowest octave
+    static const sInt volumes[] = { 64, 32, 0 };
+
+    VoiceBench b;
+    b.Buf = (sF32 *)malloc(sizeof(sF32) * VOICE_SAMPLES);
+
+    for (sInt p = 0; p < 3; p++)
+    {
+        for (sInt v = 0; v < 3; v++)
+        {
+            b.V = Paula::Voice();
+            b.V.Trigger(sample, VOICE_SAMPLE_BYTES, VOICE_SAMPLE_BYTES);
+            b.V.Period = periods[p];
+            b.V.Volume = volumes[v];
+
+            char name[64];
+            snprintf(name, sizeof(name), "voice/period=%d/volume=%d", periods[p], volumes[v]);
+            bench_run(suite, name, "cycle", PAULARATE, bench_voice, &b);
+        }
+    }
+
+    free(b.Buf);
+}
+
+// =================== CalcFrag Benchmark ===================
+// All four voices mixed into Paula's stereo ring layout
+
+struct FragBench
+{
+    Paula *P;
+    sF32 *Buf;
+};
+
+static sF64 bench_calcfrag(void *parm)
+{
+    FragBench *b = (FragBench *)parm;
+    for (sInt i = 0; i < 16; i++)
+        b->P->CalcFrag(b->Buf, Paula::RBSIZE);
+    return 16 * Paula::RBSIZE;
+}
+
+// =================== FIR Benchmark ===================
+// Filtering output frames from a stream of Paula-rate noise
+
+static const sInt FIR_STREAM = 0x10000;            // Stream size per channel
+static const sInt FIR_FRAMES = 0x800;              // Output frames per run
+
+struct FIRBench
+{
+    Paula *P;
+    sF32 *Stream;
+    sF32 *Out;
+    sInt Pos;
+    sF32 Frac;
+};
+
+static sF64 bench_fir(void *parm)
+{
+    FIRBench *b = (FIRBench *)parm;
+    b->P->FilterStream(b->Stream, FIR_STREAM, b->Pos, b->Frac, b->Out, FIR_FRAMES);
+    return FIR_FRAMES;
+}
+
+// =================== Sequencer Benchmark ===================
+// Tick() is private to the player; a sequencer pre-scan (Advance without
+// generating) runs every tick and only steps the voices, so on an
+// effect-heavy module it is dominated by Tick()
+
+static const sInt TICK_RUN_FRAMES = 60 * OUTRATE;  // Frames advanced per run
+
+// A 4 channel module whose every row triggers a note with an effect,
+// cycling through all effects the generator knows
+static void bench_sequencer_module(ModGenOptions &opt)
+{
+    modgen_defaults(opt);
+    opt.PeriodMin = 113;
+    opt.PeriodMax = 856;
+    opt.Effects = MODGEN_ALL;
+    opt.Samples = 1;
+    opt.SampleLen = 2048;
+    opt.LoopLen = 2048;
+    opt.Patterns = 4;
+    opt.Tempo = 125;
+}
+
+static sF64 bench_sequencer(void *parm)
+{
+    ModPlayer *player = (ModPlayer *)parm;
+    player->Advance(TICK_RUN_FRAMES, 0);
+    return sF64(TICK_RUN_FRAMES) / TICK_FRAMES;
+}
+
+// =================== Pattern::Load Benchmark ===================
+
+static const sInt LOAD_PATTERNS = 64;              // Patterns parsed per run
+
+struct PatternBench
+{
+    Module::Pattern *Patterns;
+    sU8 *Data;
+};
+
+static sF64 bench_pattern_load(void *parm)
+{
+    PatternBench *b = (PatternBench *)parm;
+    for (sInt i = 0; i < LOAD_PATTERNS; i++)
+        b->Patterns[i].Load(b->Data + i * MOD_PATTERN_SIZE);
+    return LOAD_PATTERNS;
+}
+
+// =================== Module Benchmarks ===================
+
+static const sInt RENDER_RUN_FRAMES = 10 * OUTRATE;   // Frames rendered per run
+
+struct ModuleBench
+{
+    ModFile File;
+    const Module *Mod;
+    sF32 *Buf;
+};
+
+// Parse (and validate) a module from memory
+static sF64 bench_parse(void *parm)
+{
+    ModuleBench *b = (ModuleBench *)parm;
+    const Module *mod = Module::Parse(b->File.Data, b->File.Size);
+    if (mod)
+        mod->Release();
+    return 1;
+}
+
+// Render the start of the song like the player does
+static sF64 bench_render(void *parm)
+{
+    ModuleBench *b = (ModuleBench *)parm;
+    Paula *p = new Paula;
+    ModPlayer *player = new ModPlayer(p, b->Mod);
+
+    for (sInt done = 0; done < RENDER_RUN_FRAMES; done += RENDER_BLOCK_SIZE)
+        player->Render(b->Buf, sMin(RENDER_BLOCK_SIZE, RENDER_RUN_FRAMES - done));
+
+    delete player;
+    delete p;
+    return RENDER_RUN_FRAMES;
+}
+
+// Parse and render benchmarks of a module image under a name
+static void bench_module_image(BenchSuite &suite, const char *base, const sU8 *data, size_t size)
+{
+    ModuleBench b;
+    b.File.Data = data;
+    b.File.Size = size;
+    b.Mod = Module::Parse(data, size);
+    if (!b.Mod)
+    {
+        fprintf(stderr, "Error: %s is not a valid MOD file\n", base);
+        return;
+    }
+    b.Buf = (sF32 *)malloc(sizeof(sF32) * 2 * RENDER_BLOCK_SIZE);
+
+    char name[64];
+    snprintf(name, sizeof(name), "parse/%s", base);
+    bench_run(suite, name, "module", 0, bench_parse, &b);
+    snprintf(name, sizeof(name), "render/%s", base);
+    bench_run(suite, name, "frame", OUTRATE, bench_render, &b);
+
+    free(b.Buf);
+    b.Mod->Release();
+}
+
+static void bench_module(BenchSuite &suite, const char *filename)
+{
+    ModFile file;
+    if (!load_mod_file(filename, file))
+        return;
+
+    const char *base = strrchr(filename, '/');
+    bench_module_image(suite, base ? base + 1 : filename, file.Data, file.Size);
+    unload_mod_file(file);
+}
+
+// The generated worst-case module (see modgen.h)
+static void bench_stress(BenchSuite &suite)
+{
+    ModGenOptions gen;
+    modgen_defaults(gen);
+    size_t size;
+    sU8 *data = modgen_build(gen, size);
+    if (data)
+        bench_module_image(suite, "stress", data, size);
+    free(data);
+}
+
+// =================== Reports ===================
+
+static void print_table(const BenchSuite &suite)
+{
+    printf("%-32s %19s %10s %12s\n", "benchmark", "ns/unit", "realtime", "cycles/unit");
+    for (sInt i = 0; i < suite.Count; i++)
+    {
+        const BenchResult &r = suite.Results[i];
+        char unit[32];
+        snprintf(unit, sizeof(unit), "/%s", r.Unit);
+
+        printf("%-32s %10.3f %-8s", r.Name, r.NsPerUnit, unit);
+        if (r.UnitRate > 0)
+            printf(" %9.1fx", 1e9 / (r.NsPerUnit * r.UnitRate));
+        else
+            printf(" %10s", "-");
+        if (r.CyclesPerUnit > 0)
+            printf(" %12.1f\n", r.CyclesPerUnit);
+        else
+            printf(" %12s\n", "-");
+    }
+}
+
+static void print_json(const BenchSuite &suite)
+{
+    printf("{\n  \"outrate\": %d,\n  \"paularate\": %d,\n  \"benchmarks\": [\n", OUTRATE, PAULARATE);
+    for (sInt i = 0; i < suite.Count; i++)
+    {
+        const BenchResult &r = suite.Results[i];
+        printf("    { \"name\": \"%s\", \"unit\": \"%s\", \"runs\": %d, \"ns_per_unit\": %.4f", r.Name, r.Unit,
+               r.Runs, r.NsPerUnit);
+        if (r.UnitRate > 0)
+            printf(", \"realtime\": %.3f", 1e9 / (r.NsPerUnit * r.UnitRate));
+        else
+            printf(", \"realtime\": null");
+        if (r.CyclesPerUnit > 0)
+            printf(", \"cycles_per_unit\": %.3f }", r.CyclesPerUnit);
+        else
+            printf(", \"cycles_per_unit\": null }");
+        printf("%s\n", i + 1 < suite.Count ? "," : "");
+    }
+    printf("  ]\n}\n");
+}
+
+static void print_usage(const char *program_name)
+{
+    printf("Usage: %s [OPTIONS] [mod files...]\n\n", program_name);
+    printf("Benchmarks the render stages and renders the given modules\n");
+    printf("(default: klisje.mod and cream_of_the_earth.mod), then the generated\n");
+    printf("worst-case module (see tinymod_modgen).\n\n");
+    printf("OPTIONS:\n");
+    printf("  --json              Print results as JSON\n");
+    printf("  --time <seconds>    Minimum time per benchmark (default 0.5)\n");
+    printf("  --filter <text>     Only run benchmarks whose name contains text\n");
+    printf("  --verify            Check all render engines against the reference output\n");
+    printf("  --seconds <n>       Verified excerpt length (default %d)\n", VERIFY_SECONDS);
+    printf("  --golden <file>     Golden hash file (default golden.txt)\n");
+    printf("  --update-golden     Store the reference hashes in the golden file\n");
+    printf("  --help              Display this help message\n");
+}
+
+// =================== Main Program ===================
+int main(int argc, const char **argv)
+{
+    static BenchSuite suite;
+    suite.MinTime = 0.5;
+    suite.Filter = NULL;
+    suite.Count = 0;
+    sBool json = 0;
+    sBool verify = 0;
+    VerifyOptions vopt;
+    vopt.Seconds = VERIFY_SECONDS;
+    vopt.Golden = "golden.txt";
+    vopt.Update = 0;
+
+    const char *files[64];
+    sInt nfiles = 0;
+
+    for (sInt i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (!strcmp(arg, "--help"))
+        {
+            print_usage(argv[0]);
+            return 0;
+        }
+        else if (!strcmp(arg, "--json"))
+            json = 1;
+        else if (!strcmp(arg, "--verify"))
+            verify = 1;
+        else if (!strcmp(arg, "--update-golden"))
+            verify = vopt.Update = 1;
+        else if (!strcmp(arg, "--seconds") && value)
+            vopt.Seconds = sMax<sF32>(atof(argv[++i]), 1);
+        else if (!strcmp(arg, "--golden") && value)
+            vopt.Golden = argv[++i];
+        else if (!strcmp(arg, "--time") && value)
+            suite.MinTime = sMax<sF64>(atof(argv[++i]), 0);
+        else if (!strcmp(arg, "--filter") && value)
+            suite.Filter = argv[++i];
+        else if (arg[0] == '-' && arg[1])
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+        else if (nfiles < 64)
+            files[nfiles++] = arg;
+    }
+
+    if (!nfiles)
+    {
+        files[nfiles++] = "klisje.mod";
+        files[nfiles++] = "cream_of_the_earth.mod";
+    }
+
+    // === Verification ===
+    if (verify)
+        return verify_run(files, nfiles, vopt) ? 1 : 0;
+
+    fprintf(stderr, "Running benchmarks...\n");
+
+    // === Voices ===
+    sU8 *sample = (sU8 *)malloc(VOICE_SAMPLE_BYTES);
+    bench_noise(sample, VOICE_SAMPLE_BYTES, 1);
+    bench_voices(suite, (const sS8 *)sample);
+
+    // === CalcFrag ===
+    {
+        static const sInt periods[4] = { 214, 428, 320, 856 };
+        FragBench b;
+        b.P = new Paula;
+        b.Buf = (sF32 *)malloc(sizeof(sF32) * 2 * Paula::RBSIZE);
+        for (sInt i = 0; i < 4; i++)
+        {
+            b.P->V[i].Trigger((const sS8 *)sample, VOICE_SAMPLE_BYTES, VOICE_SAMPLE_BYTES);
+            b.P->V[i].Period = periods[i];
+            b.P->V[i].Volume = 48;
+        }
+        bench_run(suite, "calcfrag/4-voices", "cycle", PAULARATE, bench_calcfrag, &b);
+        free(b.Buf);
+        delete b.P;
+    }
+
+    // === FIR ===
+    {
+        FIRBench b;
+        b.P = new Paula;
+        b.Stream = (sF32 *)malloc(sizeof(sF32) * 2 * FIR_STREAM);
+        b.Out = (sF32 *)malloc(sizeof(sF32) * 2 * FIR_FRAMES);
+        b.Pos = 0;
+        b.Frac = 0;
+        sU8 *noise = (sU8 *)malloc(2 * FIR_STREAM);
+        bench_noise(noise, 2 * FIR_STREAM, 3);
+        for (sInt i = 0; i < 2 * FIR_STREAM; i++)
+            b.Stream[i] = (sF32(noise[i]) - 128.0f) / 128.0f;
+        free(noise);
+
+        bench_run(suite, "fir/stereo", "frame", OUTRATE, bench_fir, &b);
+        free(b.Stream);
+        free(b.Out);
+        delete b.P;
+    }
+
+    // === Sequencer ===
+    {
+        ModGenOptions gen;
+        bench_sequencer_module(gen);
+        size_t size;
+        sU8 *data = modgen_build(gen, size);
+        const Module *mod = data ? Module::Parse(data, size) : NULL;
+        if (mod)
+        {
+            Paula p;
+            ModPlayer player(&p, mod);
+            bench_run(suite, "tick/effects", "tick", sF64(OUTRATE) / TICK_FRAMES, bench_sequencer, &player);
+            mod->Release();
+        }
+        free(data);
+    }
+
+    // === Pattern::Load ===
+    {
+        PatternBench b;
+        b.Patterns = new Module::Pattern[LOAD_PATTERNS];
+        b.Data = (sU8 *)malloc(LOAD_PATTERNS * MOD_PATTERN_SIZE);
+        bench_noise(b.Data, LOAD_PATTERNS * MOD_PATTERN_SIZE, 5);
+        bench_run(suite, "pattern/load", "pattern", 0, bench_pattern_load, &b);
+        free(b.Data);
+        delete[] b.Patterns;
+    }
+
+    free(sample);
+
+    // === End-to-End ===
+    for (sInt i = 0; i < nfiles; i++)
+        bench_module(suite, files[i]);
+    bench_stress(suite);
+
+    if (json)
+        print_json(suite);
+    else
+        print_table(suite);
+    return 0;
+}
@@ -8,6 +8,24 @@
 #define NUM_SECONDS         (1000)       // Duration to play (in seconds)
 #define SAMPLE_RATE         (96000)      // Playback sample rate (Hz)
 #define FRAMES_PER_BUFFER   (0x10000)    // Audio buffer size (65536 frames)
+#define OUTPUT_BLOCK_FRAMES (0x800)      // Default playback render block (2048 frames, ~43ms), see --buffer
+#define OUTPUT_RING_BLOCKS  (4)          // Playback ring buffer size in render blocks
+#define RENDER_BLOCK_SIZE   (0x4000)     // Offline render block size (16384 frames)
+#define PCM_TILE_FRAMES     (256)        // Frames rendered and converted at a time for integer output
+#define PARALLEL_CHUNK_SIZE (0x40000)    // Parallel render chunk size (262144 frames, ~5.5s)
+#define PARALLEL_WARMUP     (128)        // Frames rendered before a chunk to refill Paula's ring buffer
+#define PLAYLIST_PREROLL    (0x2000)     // Frames of the next playlist track rendered ahead by the loader
+#define PLAYLIST_SNAPSHOT   (0x40000)    // Track frames between restart snapshots (~5.5s, pre-scanned in a few ms)
+#define RENDER_AHEAD_GUARD  (0x1000)     // Queued frames kept when render-ahead audio is invalidated (~85ms, must cover a restart)
+#define MODULE_CACHE_MB     (64)         // Parsed module cache budget in MB, see --cache
+
+// === Build Options ===
+#ifndef TINYMOD_STATS
+#define TINYMOD_STATS       (1)          // Render stage statistics (0 = compiled out), see --stats
+#endif
+#ifndef TINYMOD_TRACE
+#define TINYMOD_TRACE       (1)          // USDT tracepoints where <sys/sdt.h> exists (0 = left out), see trace.h
+#endif
 
 // === Paula Chip Emulation ===
 // These constants define the Amiga Paula chip parameters
@@ -25,6 +43,9 @@ const int MOD_SAMPLES = 32;                // Maximum 32 samples per MOD file
 const int MOD_PATTERNS = 128;              // Maximum 128 patterns per MOD file
 const int MOD_PATTERN_ROWS = 64;           // 64 rows per pattern
 const int MOD_PATTERN_SIZE = 1024;         // 1024 bytes per pattern
+const int MOD_HEADER_SIZE = 1084;          // Header size up to and including the format tag
+const int MOD_SAMPLE_HEADER_SIZE = 30;     // Bytes per sample header
+const int SAMPLE_LOOP_MIN = 512;           // Sample loops are repeated to at least this many bytes
 
 // === Utility Macros ===
 #define cls()               printf("\033[H\033[J")  // ANSI escape codes to clear screen
@@ -0,0 +1,164 @@
+// =================== Real-Time Headroom Monitor Implementation ===================
+
+#include "headroom.h"
+
+// =================== HeadroomMonitor Constructor ===================
+HeadroomMonitor::HeadroomMonitor()
+    : Rate(1), Blocks(0), Overruns(0), TotalNs(0), MaxNs(0), LoadSum(0), LoadMin(~sU64(0)), LoadMax(0), Underruns(0),
+      UnderrunFrames(0), DeviceUnderflows(0)
+{
+    for (sInt i = 0; i < BINS; i++)
+        Histogram[i] = 0;
+}
+
+// =================== HeadroomMonitor::SetRate ===================
+void HeadroomMonitor::SetRate(sInt rate)
+{
+    Rate = sMax(rate, 1);
+}
+
+// =================== HeadroomMonitor::Record ===================
+// Single writer: min/max need no compare-exchange loop
+void HeadroomMonitor::Record(sF64 seconds, sInt frames)
+{
+    if (frames <= 0)
+        return;
+
+    sF64 load = seconds * Rate / frames;
+    sU64 ppm = sU64(load * 1e6 + 0.5);
+    sU64 ns = sU64(seconds * 1e9);
+
+    Histogram[sMin(sInt(load * 100), BINS - 1)].fetch_add(1, std::memory_order_relaxed);
+    if (load > 1.0)
+        Overruns.fetch_add(1, std::memory_order_relaxed);
+    TotalNs.fetch_add(ns, std::memory_order_relaxed);
+    if (ns > MaxNs.load(std::memory_order_relaxed))
+        MaxNs.store(ns, std::memory_order_relaxed);
+    LoadSum.fetch_add(ppm, std::memory_order_relaxed);
+    if (ppm < LoadMin.load(std::memory_order_relaxed))
+        LoadMin.store(ppm, std::memory_order_relaxed);
+    if (ppm > LoadMax.load(std::memory_order_relaxed))
+        LoadMax.store(ppm, std::memory_order_relaxed);
+    Blocks.fetch_add(1, std::memory_order_relaxed);
+}
+
+// =================== HeadroomMonitor Underruns ===================
+void HeadroomMonitor::AddUnderrun(sInt frames)
+{
+    Underruns.fetch_add(1, std::memory_order_relaxed);
+    UnderrunFrames.fetch_add(frames, std::memory_order_relaxed);
+}
+
+void HeadroomMonitor::AddDeviceUnderflow()
+{
+    DeviceUnderflows.fetch_add(1, std::memory_order_relaxed);
+}
+
+// =================== HeadroomMonitor::GetStats ===================
+void HeadroomMonitor::GetStats(HeadroomStats &s) const
+{
+    s.Blocks = Blocks.load(std::memory_order_relaxed);
+    sU64 min = LoadMin.load(std::memory_order_relaxed);
+    s.MinLoad = s.Blocks ? sF64(min) * 1e-6 : 0;
+    s.AvgLoad = s.Blocks ? sF64(LoadSum.load(std::memory_order_relaxed)) * 1e-6 / s.Blocks : 0;
+    s.MaxLoad = sF64(LoadMax.load(std::memory_order_relaxed)) * 1e-6;
+    s.TotalTime = sF64(TotalNs.load(std::memory_order_relaxed)) * 1e-9;
+    s.MaxTime = sF64(MaxNs.load(std::memory_order_relaxed)) * 1e-9;
+    s.Overruns = Overruns.load(std::memory_order_relaxed);
+    s.Underruns = Underruns.load(std::memory_order_relaxed);
+    s.UnderrunFrames = UnderrunFrames.load(std::memory_order_relaxed);
+    s.DeviceUnderflows = DeviceUnderflows.load(std::memory_order_relaxed);
+
+    // 99th percentile: upper edge of the bin holding it
+    sU64 total = 0;
+    for (sInt i = 0; i < BINS; i++)
+        total += Histogram[i].load(std::memory_order_relaxed);
+    sU64 rank = total - total / 100, seen = 0;
+    s.P99Load = 0;
+    for (sInt i = 0; i < BINS && total; i++)
+    {
+        seen += Histogram[i].load(std::memory_order_relaxed);
+        if (seen >= rank)
+        {
+            s.P99Load = sMin(sF64(i + 1) / 100, s.MaxLoad);
+            break;
+        }
+    }
+}
+
+// =================== HeadroomMonitor::GetBin ===================
+sU64 HeadroomMonitor::GetBin(sInt bin) const
+{
+    return (bin >= 0 && bin < BINS) ? Histogram[bin].load(std::memory_order_relaxed) : 0;
+}
+
+// =================== HeadroomMonitor::PrintStatus ===================
+void HeadroomMonitor::PrintStatus(FILE *out) const
+{
+    HeadroomStats s;
+    GetStats(s);
+    fprintf(out, "Load %.0f%% avg, %.0f%% p99, %.0f%% max | overruns %llu, underruns %llu, device %llu",
+            100 * s.AvgLoad, 100 * s.P99Load, 100 * s.MaxLoad, (unsigned long long)s.Overruns,
+            (unsigned long long)s.Underruns, (unsigned long long)s.DeviceUnderflows);
+}
+
+// =================== HeadroomMonitor::PrintHistogram ===================
+void HeadroomMonitor::PrintHistogram(FILE *out) const
+{
+    // Range upper edges in percent; the last range is open
+    static const sInt edges[] = { 10, 25, 50, 75, 100, 150 };
+    const sInt ranges = sInt(sizeof(edges) / sizeof(edges[0])) + 1;
+
+    sU64 total = Blocks.load(std::memory_order_relaxed);
+    sInt bin = 0;
+    for (sInt r = 0; r < ranges; r++)
+    {
+        sInt end = r < ranges - 1 ? edges[r] : BINS;
+        sU64 count = 0;
+        for (; bin < end; bin++)
+            count += Histogram[bin].load(std::memory_order_relaxed);
+
+        char label[32];
+        if (r < ranges - 1)
+            snprintf(label, sizeof(label), "%3d-%3d%%", r ? edges[r - 1] : 0, edges[r]);
+        else
+            snprintf(label, sizeof(label), "   >%3d%%", edges[r - 1]);
+
+        sInt bar = total ? sInt(40 * count / total) : 0;
+        fprintf(out, "  %s %8llu %5.1f%% ", label, (unsigned long long)count, total ? 100.0 * count / total : 0.0);
+        for (sInt i = 0; i < bar; i++)
+            fputc('#', out);
+        fputc('\n', out);
+    }
+}
+
+// =================== HeadroomMonitor::WriteDump ===================
+sBool HeadroomMonitor::WriteDump(FILE *out, sInt block_frames) const
+{
+    HeadroomStats s;
+    GetStats(s);
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"rate\": %d,\n  \"block_frames\": %d,\n  \"blocks\": %llu,\n", Rate, block_frames,
+            (unsigned long long)s.Blocks);
+    fprintf(out, "  \"render_seconds\": %.6f,\n  \"max_block_seconds\": %.6f,\n", s.TotalTime, s.MaxTime);
+    fprintf(out, "  \"load\": { \"min\": %.4f, \"avg\": %.4f, \"p99\": %.4f, \"max\": %.4f },\n", s.MinLoad,
+            s.AvgLoad, s.P99Load, s.MaxLoad);
+    fprintf(out, "  \"overruns\": %llu,\n  \"underruns\": %llu,\n  \"underrun_frames\": %llu,\n",
+            (unsigned long long)s.Overruns, (unsigned long long)s.Underruns, (unsigned long long)s.UnderrunFrames);
+    fprintf(out, "  \"device_underflows\": %llu,\n", (unsigned long long)s.DeviceUnderflows);
+
+    // Non-empty 1% bins as [lower edge in percent, blocks]
+    fprintf(out, "  \"histogram\": [");
+    sBool first = 1;
+    for (sInt i = 0; i < BINS; i++)
+    {
+        sU64 count = Histogram[i].load(std::memory_order_relaxed);
+        if (!count)
+            continue;
+        fprintf(out, "%s[%d, %llu]", first ? "" : ", ", i, (unsigned long long)count);
+        first = 0;
+    }
+    fprintf(out, "]\n}\n");
+    return !ferror(out);
+}
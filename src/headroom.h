@@ -0,0 +1,93 @@
+// =================== Real-Time Headroom Monitor ===================
+// Tracks how close playback runs to dropping out. Each rendered block's
+// render time is compared with the time the block plays for (its load:
+// 100% = no headroom left) and counted in a histogram of 1% wide bins,
+// from which min/avg/p99/max are derived. Blocks that took longer than
+// they play for are render overruns. Ring underruns (silence inserted
+// because the render thread fell behind) and underflows reported by the
+// audio device are counted as well.
+// Record() is called from one render thread, the underrun counters from
+// the consumer (also inside audio callbacks); everything is lock-free
+// and can be read from any thread at any time.
+
+#ifndef HEADROOM_H
+#define HEADROOM_H
+
+#include <stdio.h>
+#include <atomic>
+#include "types.h"
+
+// =================== Headroom Snapshot ===================
+struct HeadroomStats
+{
+    sU64 Blocks;                           // Blocks rendered
+    sF64 MinLoad;                          // Lowest block load (1.0 = 100%)
+    sF64 AvgLoad;                          // Average block load
+    sF64 P99Load;                          // 99th percentile block load (histogram resolution)
+    sF64 MaxLoad;                          // Highest block load
+    sF64 TotalTime;                        // Seconds spent rendering
+    sF64 MaxTime;                          // Slowest block in seconds
+    sU64 Overruns;                         // Blocks that took longer than they play for
+    sU64 Underruns;                        // Pulls that found the ring short
+    sU64 UnderrunFrames;                   // Frames of silence inserted by underruns
+    sU64 DeviceUnderflows;                 // Output underflows reported by the device
+};
+
+// =================== HeadroomMonitor Class ===================
+class HeadroomMonitor
+{
+public:
+    static const sInt BINS = 400;          // 1% load bins; the last one also takes everything above
+
+private:
+    sInt Rate;                             // Output sample rate
+
+    // Render thread side
+    std::atomic<sU64> Blocks;
+    std::atomic<sU64> Overruns;
+    std::atomic<sU64> TotalNs;             // Render time in nanoseconds
+    std::atomic<sU64> MaxNs;               // Slowest block in nanoseconds
+    std::atomic<sU64> LoadSum;             // Sum of block loads in ppm
+    std::atomic<sU64> LoadMin;             // Lowest block load in ppm
+    std::atomic<sU64> LoadMax;             // Highest block load in ppm
+    std::atomic<sU64> Histogram[BINS];     // Blocks per 1% load bin
+
+    // Consumer side
+    std::atomic<sU64> Underruns;
+    std::atomic<sU64> UnderrunFrames;
+    std::atomic<sU64> DeviceUnderflows;
+
+public:
+    HeadroomMonitor();
+
+    // Output sample rate, needed to turn frames into play time
+    void SetRate(sInt rate);
+
+    // Account one block of frames that took seconds to render (render thread)
+    void Record(sF64 seconds, sInt frames);
+
+    // Account a ring underrun that inserted frames of silence
+    void AddUnderrun(sInt frames);
+
+    // Account an output underflow reported by the device
+    void AddDeviceUnderflow();
+
+    // Read all counters
+    void GetStats(HeadroomStats &s) const;
+
+    // Blocks in a 1% load bin
+    sU64 GetBin(sInt bin) const;
+
+    // Print a one-line status without a line end ("Load 23% avg, ...")
+    void PrintStatus(FILE *out) const;
+
+    // Print the load histogram in coarse ranges
+    void PrintHistogram(FILE *out) const;
+
+    // Write all counters and the full histogram as JSON
+    // block_frames: nominal block size, only recorded in the dump
+    // Returns false on write errors
+    sBool WriteDump(FILE *out, sInt block_frames) const;
+};
+
+#endif // HEADROOM_H
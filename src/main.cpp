@@ -14,6 +14,8 @@
 #include <string.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <signal.h>
+#include <termios.h>
 #include <sys/stat.h>
 #include <portaudio.h>
 
@@ -21,6 +23,16 @@
 #include "config.h"
 #include "paula.h"
 #include "modplayer.h"
+#include "wavwriter.h"
+#include "render.h"
+#include "module.h"
+#include "batch.h"
+#include "streamout.h"
+#include "sink.h"
+#include "playlist.h"
+#include "renderahead.h"
+#include "stats.h"
+#include "headroom.h"
 
 // =================== Audio Configuration Constants ===================
 const int SAMPLE_RATE_INTERNAL = 96000;    // Internal Paula emulation rate
@@ -28,59 +40,6 @@ const int SAMPLE_RATE_OUTPUT = 48000;      // Output audio sample rate
 
 // =================== Utility Functions ===================
 
-// Load MOD file from disk into memory
-// Returns pointer to allocated memory containing file data
-// Sets file_size to the number of bytes read
-sU8 *load_mod_file(const char *filename, size_t &file_size)
-{
-    // Open file for reading in binary mode
-    FILE *fh = fopen(filename, "rb");
-    if (!fh)
-    {
-        perror("fopen");
-        return NULL;
-    }
-
-    // Get file size using stat()
-    struct stat sb;
-    if (stat(filename, &sb) == -1)
-    {
-        perror("stat");
-        fclose(fh);
-        return NULL;
-    }
-
-    file_size = sb.st_size;
-
-    // Allocate memory for file (4MB max)
-    if (file_size > 4 * 1024 * 1024)
-    {
-        fprintf(stderr, "Error: MOD file too large (max 4MB)\n");
-        fclose(fh);
-        return NULL;
-    }
-
-    sU8 *mod = (sU8 *)malloc(file_size);
-    if (!mod)
-    {
-        perror("malloc");
-        fclose(fh);
-        return NULL;
-    }
-
-    // Read file into memory
-    if (fread(mod, file_size, 1, fh) != 1)
-    {
-        perror("fread");
-        free(mod);
-        fclose(fh);
-        return NULL;
-    }
-
-    fclose(fh);
-    return mod;
-}
-
 // PortAudio error handler
 // Prints error information and terminates program
 void handle_pa_error(PaError err)
@@ -106,8 +65,37 @@ void handle_pa_error(PaError err)
 // Print usage information
 void print_usage(const char *program_name)
 {
-    printf("Usage: %s [<mod file>|OPTION]\n\n", program_name);
+    printf("Usage: %s [OPTIONS] <mod file|playlist.m3u> [...]\n\n", program_name);
     printf("OPTIONS:\n");
+    printf("  --render <file>     Render offline to a file ('-' = stdout) instead of playing\n");
+    printf("  --format <fmt>      Render sample format: f32, s16, s24, s32 (default f32)\n");
+    printf("  --dither            Add TPDF dither when writing integer formats\n");
+    printf("  --raw               Render headerless raw PCM instead of WAV\n");
+    printf("  --loops <n>         Times to play the song, 0 = forever\n");
+    printf("                      (default: 0 when playing, 1 when rendering)\n");
+    printf("  --fade <seconds>    Fade out over the given time after the last loop\n");
+    printf("  --seconds <n>       Maximum duration, per track (default %d)\n", NUM_SECONDS);
+    printf("  --mute <channels>   Mute channels, comma separated (1-4, e.g. 2,3)\n");
+    printf("  --solo <channels>   Mute all other channels\n");
+    printf("  --threads <n>       Split a render across n threads (0 = one per CPU core)\n");
+    printf("  --fir-threads <n>   Share the FIR of each render block among n threads\n");
+    printf("  --pipeline          Generate voices on a second thread, FIR on the output thread\n");
+    printf("  --blocking          Play with blocking writes instead of a callback stream\n");
+    printf("  --buffer <frames>   Playback render block size (default %d,\n", OUTPUT_BLOCK_FRAMES);
+    printf("                      %d with --blocking, which writes into a 2 block device buffer)\n",
+           FRAMES_PER_BUFFER / 2);
+    printf("  --latency <ms>      Suggested device latency (default: device low latency)\n");
+    printf("  --ahead <seconds>   Keep this much audio rendered ahead (default 0 = off)\n");
+    printf("  --sink <type>       Playback output: portaudio (default), null, null-paced,\n");
+    printf("                      wav <file>, stdout (uses --format/--raw)\n");
+    printf("  --batch <dir|list>  Render or analyse many modules in parallel\n");
+    printf("                      (directory scanned recursively, or file list, '-' = stdin)\n");
+    printf("  --outdir <dir>      Batch output directory (omit to only analyse)\n");
+    printf("  --jobs <n>          Batch worker threads (default: one per CPU core)\n");
+    printf("  --cache <MB>        Parsed module cache budget (default %d, 0 = off)\n", MODULE_CACHE_MB);
+    printf("  --stats             Show time spent per render stage (tick, voices, FIR)\n");
+    printf("  --dump-headroom <file>\n");
+    printf("                      Write render load and underrun counters as JSON\n");
     printf("  --about             Display about message\n");
     printf("  --help              Display this help message\n");
 }
@@ -124,77 +112,351 @@ void print_about()
     printf("Released into the public domain.\n");
 }
 
-// =================== Main Program ===================
-int main(int argc, const char **argv)
+// Parse a comma separated channel list such as "1,3" into a channel mask
+// Returns -1 on an invalid list
+static sInt parse_channels(const char *list)
 {
-    // === Check Command Line Arguments ===
-    if (argc != 2)
+    sInt mask = 0;
+    while (*list)
     {
-        print_usage(argv[0]);
+        char *end;
+        long ch = strtol(list, &end, 10);
+        if (end == list || ch < 1 || ch > MOD_CHANNELS || (*end && *end != ','))
+            return -1;
+        mask |= 1 << (ch - 1);
+        list = *end ? end + 1 : end;
+    }
+    return mask;
+}
+
+// Render a MOD file offline to a file or stdout
+// Status goes to stderr so stdout can carry the audio data
+int render_mode(const char *filename, const char *outname, const RenderOptions &opt, sBool stats)
+{
+    const Module *mod = Module::Load(filename);
+    if (!mod)
+    {
+        fprintf(stderr, "Error: Failed to load MOD file\n");
         return 1;
     }
 
-    const char *filename = argv[1];
+    sBool to_stdout = !strcmp(outname, "-");
+    FILE *out = to_stdout ? stdout : fopen(outname, "wb");
+    if (!out)
+    {
+        perror("fopen");
+        mod->Release();
+        return 1;
+    }
 
-    // Handle --about option
-    if (!strcmp(filename, "--about"))
+    RenderResult res;
+    sBool ok = render_to_file(mod, out, opt, res);
+
+    if (!to_stdout && fclose(out) != 0)
+        ok = 0;
+    mod->Release();
+
+    if (!ok)
     {
-        print_about();
+        fprintf(stderr, "Error: Failed to write %s\n", outname);
+        return 1;
+    }
+
+    // Report achieved speed as a multiple of realtime
+    sF64 audio = sF64(res.Frames) / OUTRATE;
+    fprintf(stderr, "Rendered %.2f seconds of audio in %.2f seconds (%.1fx realtime)%s\n",
+            audio, res.Seconds, res.Seconds > 0 ? audio / res.Seconds : 0.0,
+            res.Finished ? "" : ", stopped at time limit");
+
+    // Stage times are summed over all threads, so they can exceed 100%
+    if (stats)
+    {
+        StageStats now[STATS_STAGES];
+        stats_get(now);
+        fprintf(stderr, "Stages: ");
+        stats_print(stderr, now, NULL, res.Seconds);
+    }
+    return 0;
+}
+
+// =================== Keyboard Controls ===================
+// While playing from a terminal, single keys change volume, separation
+// and position; stdin is switched to non-canonical mode for this
+
+static struct termios saved_term;          // Terminal settings to restore
+static sBool term_changed = 0;
+
+// Restore the terminal settings
+static void term_restore()
+{
+    if (term_changed)
+        tcsetattr(STDIN_FILENO, TCSANOW, &saved_term);
+    term_changed = 0;
+}
+
+// Restore the terminal before Ctrl+C ends the program
+static void term_signal(int sig)
+{
+    term_restore();
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+// Read keys without waiting for Enter or echoing them
+// Returns false if stdin is not a terminal
+static sBool term_begin()
+{
+    if (!isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &saved_term) != 0)
         return 0;
+
+    struct termios term = saved_term;
+    term.c_lflag &= ~(ICANON | ECHO);
+    term.c_cc[VMIN] = 0;                   // read() returns at once
+    term.c_cc[VTIME] = 0;
+    if (tcsetattr(STDIN_FILENO, TCSANOW, &term) != 0)
+        return 0;
+
+    term_changed = 1;
+    signal(SIGINT, term_signal);
+    signal(SIGTERM, term_signal);
+    return 1;
+}
+
+// Apply one key press; queued audio is rendered again so the change is
+// heard after the render-ahead guard interval instead of the whole horizon
+static void handle_key(sInt key, PlaylistPlayer &source, RenderAhead *ahead, FILE *msg)
+{
+    sF32 vol, sep;
+    source.GetMix(vol, sep);
+
+    switch (key)
+    {
+    case '+': case '=': vol += 0.05f; break;
+    case '-':           vol -= 0.05f; break;
+    case ']':           sep += 0.1f;  break;
+    case '[':           sep -= 0.1f;  break;
+    case '.':
+    case ',':
+        source.Seek(key == '.' ? 5.0f : -5.0f);
+        if (ahead)
+            ahead->Invalidate();
+        fprintf(msg, "\nSeek %s5 seconds\n", key == '.' ? "+" : "-");
+        return;
+    case '1': case '2': case '3': case '4':
+    {
+        sInt ch = key - '1';
+        sInt mute = source.GetMute() ^ (1 << ch);
+        source.SetMute(mute);
+        if (ahead)
+            ahead->Invalidate();
+        fprintf(msg, "\nChannel %d %s\n", ch + 1, ((mute >> ch) & 1) ? "muted" : "unmuted");
+        return;
     }
+    default:
+        return;
+    }
+
+    vol = sClamp(vol, 0.0f, 1.0f);
+    sep = sClamp(sep, 0.0f, 1.0f);
+    source.SetMix(vol, sep);
+    if (ahead)
+        ahead->Invalidate();
+    fprintf(msg, "\nVolume %.2f, separation %.1f\n", vol, sep);
+}
+
+// =================== Playback ===================
 
-    // Handle --help option
-    if (!strcmp(filename, "--help"))
+// Print the render load summary and histogram after playback and
+// write the JSON dump if one was asked for
+// Returns false if the dump could not be written
+static sBool report_headroom(const HeadroomMonitor &mon, sInt block_frames, const char *dump, FILE *msg)
+{
+    HeadroomStats s;
+    mon.GetStats(s);
+    sF64 block_ms = block_frames * 1000.0 / SAMPLE_RATE_OUTPUT;
+    fprintf(msg, "Render load (%.1f ms blocks): %.1f%% min, %.1f%% avg, %.0f%% p99, %.1f%% max, %llu overruns\n",
+            block_ms, 100 * s.MinLoad, 100 * s.AvgLoad, 100 * s.P99Load, 100 * s.MaxLoad,
+            (unsigned long long)s.Overruns);
+    mon.PrintHistogram(msg);
+
+    if (!dump)
+        return 1;
+    FILE *fh = fopen(dump, "w");
+    if (!fh)
     {
-        print_usage(argv[0]);
+        perror(dump);
         return 0;
     }
+    sBool ok = mon.WriteDump(fh, block_frames);
+    ok = (fclose(fh) == 0) && ok;
+    if (!ok)
+        fprintf(stderr, "Error: Failed to write %s\n", dump);
+    else
+        fprintf(msg, "Headroom counters written to %s\n", dump);
+    return ok;
+}
 
-    // === Load MOD File ===
-    printf("Loading MOD file: %s\n", filename);
-    size_t mod_size = 0;
-    sU8 *mod_data = load_mod_file(filename, mod_size);
+// Play through a sink fed by a render thread
+// block_frames: frames rendered per call, the ring holds OUTPUT_RING_BLOCKS blocks
+// ahead_frames: render-ahead horizon in frames (0 = render just in time)
+// stats: print render stage statistics every second instead of the load
+// dump: file for the headroom counters (NULL = none)
+// Status goes to msg (stderr when the audio itself goes to stdout)
+sBool play_stream(AudioSink *sink, PlaylistPlayer &source, sInt block_frames, sInt ahead_frames, sBool stats,
+                  const char *dump, FILE *msg)
+{
+    // Optional render-ahead queue between the playlist and the output ring
+    // (declared after out so it is stopped first on an early return)
+    StreamOutput out;
+    RenderAhead ahead;
+    StreamRenderFunc func = PlaylistPlayer::RenderProxy;
+    void *parm = &source;
+    if (ahead_frames > 0)
+    {
+        if (!ahead.Open(ahead_frames, ahead_frames / 2, block_frames, PlaylistPlayer::RenderProxy,
+                        PlaylistPlayer::RewindProxy, &source))
+        {
+            fprintf(stderr, "Error: Failed to allocate render-ahead buffer\n");
+            return 0;
+        }
+        func = RenderAhead::RenderProxy;
+        parm = &ahead;
+    }
 
-    if (!mod_data)
+    sInt ring_frames = OUTPUT_RING_BLOCKS * block_frames;
+    if (!out.Open(SAMPLE_RATE_OUTPUT, ring_frames, block_frames, func, parm, ~sU64(0)))
     {
-        fprintf(stderr, "Error: Failed to load MOD file\n");
-        return 1;
+        fprintf(stderr, "Error: Failed to allocate audio buffer\n");
+        return 0;
     }
 
-    printf("Loaded %zu bytes\n", mod_size);
+    // With render-ahead the output thread only copies queued audio: the
+    // headroom monitor times the blocks the render-ahead thread renders
+    if (ahead_frames > 0)
+    {
+        out.SetTimed(0);
+        ahead.SetMonitor(&out.GetMonitor());
+        ahead.Start();
+    }
 
-    // === Initialize PortAudio ===
-    printf("Initializing PortAudio...\n");
-    PaError err = Pa_Initialize();
-    if (err != paNoError)
-        handle_pa_error(err);
+    out.Start();
+    sF64 start = sGetTime();
+    if (!sink->Start(&out))
+        return 0;
 
-    // === Configure Output Stream ===
-    PaStreamParameters outputParameters;
-    outputParameters.device = Pa_GetDefaultOutputDevice();
+    fprintf(msg, "Buffering: %d frame blocks, %d frame ring (%.1f ms)\n", block_frames, ring_frames,
+            ring_frames * 1000.0 / SAMPLE_RATE_OUTPUT);
+    if (ahead_frames > 0)
+        fprintf(msg, "Render-ahead: %.1f seconds, refilled below %.1f seconds\n",
+                sF64(ahead_frames) / SAMPLE_RATE_OUTPUT, sF64(ahead_frames / 2) / SAMPLE_RATE_OUTPUT);
+
+    sBool keys = term_begin();
+    if (keys)
+        fprintf(msg, "Keys: +/- volume, [/] separation, ,/. seek 5 seconds, 1-4 mute channel\n");
+    if (sink->GetLatency() > 0)
+        fprintf(msg, "Output latency: %.1f ms (device)\n", sink->GetLatency() * 1000.0);
+
+    // The render thread and the sink do the work; just show the load
+    // (track changes are shown when rendered, up to a ring ahead of the output)
+    sInt ticks = 0;
+    sInt track = source.GetCurrent();
+    StageStats prev[STATS_STAGES];
+    stats_get(prev);
+    sF64 prevtime = start;
+    while (!out.IsDone())
+    {
+        Pa_Sleep(100);
+        char key;
+        while (keys && read(STDIN_FILENO, &key, 1) == 1)
+            handle_key(key, source, ahead_frames > 0 ? &ahead : NULL, msg);
+        sInt cur = source.GetCurrent();
+        if (cur != track && cur >= 0)
+        {
+            fprintf(msg, "\nNow playing: %s (%d/%d)\n", source.GetInfo(cur).Name, cur + 1, source.GetCount());
+            track = cur;
+        }
+        if (++ticks % 10 == 0 && stats)
+        {
+            StageStats now[STATS_STAGES];
+            stats_get(now);
+            sF64 time = sGetTime();
+            stats_print(msg, now, prev, time - prevtime);
+            sCopyMem(prev, now, sizeof(prev));
+            prevtime = time;
+        }
+        else if (ticks % 10 == 0)
+        {
+            fprintf(msg, "\r");
+            out.GetMonitor().PrintStatus(msg);
+            fflush(msg);
+        }
+    }
+    fprintf(msg, "\n\n");
+    term_restore();
+
+    // The sink first, then the render-ahead thread (releasing a render
+    // call waiting on it), then the output ring
+    sBool ok = sink->Stop();
+    ahead.Stop();
+    out.Stop();
+    sF64 wall = sGetTime() - start;
+
+    // Render cost relative to the time one block plays for
+    sF64 avg, peak;
+    out.GetRenderCost(avg, peak);
+    sF64 block_time = sF64(block_frames) / SAMPLE_RATE_OUTPUT;
+    fprintf(msg, "Render cost: %.1f us average, %.1f us peak per block (%.1f%% / %.1f%% of realtime)\n",
+            avg * 1e6, peak * 1e6, 100.0 * avg / block_time, 100.0 * peak / block_time);
+    if (ahead_frames > 0)
+    {
+        fprintf(msg, "Render-ahead: lowest fill %.2f seconds, %llu refills, %llu stalls, %llu invalidations\n",
+                sF64(ahead.GetMinFill()) / SAMPLE_RATE_OUTPUT, (unsigned long long)ahead.GetRefills(),
+                (unsigned long long)ahead.GetStalls(), (unsigned long long)ahead.GetInvalidations());
+    }
 
-    if (outputParameters.device == paNoDevice)
+    if (stats)
     {
-        fprintf(stderr, "Error: No default output device found\n");
-        Pa_Terminate();
-        free(mod_data);
-        return 1;
+        StageStats now[STATS_STAGES];
+        stats_get(now);
+        fprintf(msg, "Stages: ");
+        stats_print(msg, now, NULL, wall);
     }
 
-    outputParameters.channelCount = 2;                 // Stereo output
-    outputParameters.sampleFormat = paFloat32;         // 32-bit float samples
-    outputParameters.suggestedLatency =
-        Pa_GetDeviceInfo(outputParameters.device)->defaultLowOutputLatency;
-    outputParameters.hostApiSpecificStreamInfo = NULL;
+    if (sink->IsRealtime())
+    {
+        HeadroomStats hs;
+        out.GetMonitor().GetStats(hs);
+        fprintf(msg, "Underruns: %llu (%.1f ms of silence inserted), %llu device underflows\n",
+                (unsigned long long)hs.Underruns, hs.UnderrunFrames * 1000.0 / SAMPLE_RATE_OUTPUT,
+                (unsigned long long)hs.DeviceUnderflows);
+    }
+    else
+    {
+        sF64 audio = sF64(out.GetPlayedFrames()) / SAMPLE_RATE_OUTPUT;
+        fprintf(msg, "Consumed %.2f seconds of audio in %.2f seconds (%.1fx realtime)\n", audio, wall,
+                wall > 0 ? audio / wall : 0.0);
+    }
+
+    ok = report_headroom(out.GetMonitor(), block_frames, dump, msg) && ok;
 
+    if (!ok)
+        fprintf(stderr, "Error: Audio output failed\n");
+    return ok;
+}
+
+// Play with blocking writes on the main thread
+// nwrite: frames rendered and written per call (the device buffer holds two)
+// dump: file for the headroom counters (NULL = none)
+sBool play_blocking(const PaStreamParameters &params, PlaylistPlayer &source, sInt nwrite, const char *dump)
+{
     // === Open Audio Stream ===
     PaStream *stream;
-    err = Pa_OpenStream(
+    PaError err = Pa_OpenStream(
         &stream,
         NULL,                              // No input
-        &outputParameters,
+        &params,
         SAMPLE_RATE_OUTPUT,               // Output sample rate
-        FRAMES_PER_BUFFER,                // Frames per buffer
+        nwrite * 2,                       // Frames per buffer
         paClipOff,                        // Don't clip output
         NULL,                             // No callback
         NULL);                            // No user data
@@ -207,52 +469,48 @@ int main(int argc, const char **argv)
     if (err != paNoError)
         handle_pa_error(err);
 
-    // === Initialize MOD Player and Paula Emulator ===
-    Paula paula;                          // Create Paula emulator instance
-    ModPlayer player(&paula, mod_data);   // Create MOD player with MOD file
-
-    // === Display Playback Information ===
-    cls();  // Clear screen
-    printf("TinyMOD - Amiga MOD File Player\n");
-    printf("================================\n\n");
-    printf("Currently playing: %s\n", player.Name);
-    printf("Duration: %d seconds\n", NUM_SECONDS);
-    printf("Sample rate: %d Hz (Paula: %d Hz)\n", SAMPLE_RATE_OUTPUT, SAMPLE_RATE_INTERNAL);
-    printf("\nPress Ctrl+C to stop\n\n");
-
-    // === Calculate Playback Parameters ===
-    sInt nwrite = FRAMES_PER_BUFFER / 2;  // Samples per buffer
-    sInt buffer_count = (NUM_SECONDS * SAMPLE_RATE_OUTPUT) / FRAMES_PER_BUFFER;
-
     // === Allocate Audio Buffers ===
     sF32 *mixbuffer = (sF32 *)malloc(nwrite * 2 * sizeof(sF32));
     if (!mixbuffer)
     {
         fprintf(stderr, "Error: Failed to allocate audio buffer\n");
         Pa_CloseStream(stream);
-        Pa_Terminate();
-        free(mod_data);
-        return 1;
+        return 0;
     }
 
     // === Main Playback Loop ===
-    printf("Playing...\n");
-    for (int i = 0; i < buffer_count; i++)
+    HeadroomMonitor monitor;
+    monitor.SetRate(SAMPLE_RATE_OUTPUT);
+    sInt status = sMax(SAMPLE_RATE_OUTPUT / nwrite, 1);   // Blocks per status line (about a second)
+    for (int i = 0; ; i++)
     {
-        // Render MOD file audio
-        player.RenderProxy(&player, mixbuffer, nwrite);
-
-        // Write audio to stream
-        err = Pa_WriteStream(stream, mixbuffer, nwrite);
-        if (err != paNoError)
+        // Render MOD file audio (the playlist stops at each track's time limit)
+        sF64 start = sGetTime();
+        sU32 frames = source.Render(mixbuffer, nwrite);
+        monitor.Record(sGetTime() - start, sInt(frames));
+
+        // Write audio to stream (an underflow means the device ran dry
+        // before this write; the data is still queued)
+        if (frames)
         {
-            fprintf(stderr, "Warning: Write error - %s\n", Pa_GetErrorText(err));
+            err = Pa_WriteStream(stream, mixbuffer, frames);
+            if (err == paOutputUnderflowed)
+                monitor.AddDeviceUnderflow();
+            else if (err != paNoError)
+            {
+                fprintf(stderr, "Warning: Write error - %s\n", Pa_GetErrorText(err));
+            }
         }
 
-        // Print progress
-        if ((i + 1) % 10 == 0)
+        // Stop once the last song has ended
+        if (source.IsFinished())
+            break;
+
+        // Print the load
+        if ((i + 1) % status == 0)
         {
-            printf(".");
+            printf("\r");
+            monitor.PrintStatus(stdout);
             fflush(stdout);
         }
     }
@@ -271,12 +529,269 @@ int main(int argc, const char **argv)
     if (err != paNoError)
         handle_pa_error(err);
 
-    Pa_Terminate();
+    free(mixbuffer);
+
+    HeadroomStats hs;
+    monitor.GetStats(hs);
+    printf("Device underflows: %llu\n", (unsigned long long)hs.DeviceUnderflows);
+    return report_headroom(monitor, nwrite, dump, stdout);
+}
+
+// =================== Main Program ===================
+int main(int argc, const char **argv)
+{
+    // === Parse Command Line Arguments ===
+    Playlist list;                         // Modules to play, in order
+    playlist_init(list);
+    const char *render_name = NULL;
+    const char *batch_source = NULL;
+    RenderOptions ropt;
+    render_defaults(ropt);
+    BatchOptions bopt;
+    bopt.OutDir = NULL;
+    bopt.Jobs = 0;
+    bopt.CacheBytes = size_t(MODULE_CACHE_MB) << 20;
+    sInt loops = -1;                       // -1 = default for the chosen mode
+    sBool blocking = 0;                    // Blocking writes instead of a callback stream
+    sInt buffer_frames = 0;                // 0 = default for the chosen mode
+    sF32 latency_ms = -1;                  // -1 = device default low latency
+    sF32 ahead_seconds = 0;                // Render-ahead horizon (0 = off)
+    sBool stats = 0;                       // Print render stage statistics
+    const char *dump_name = NULL;          // Headroom counter dump (JSON)
+    sInt sink_type = SINK_PORTAUDIO;
+    const char *sink_name = NULL;          // Output file of the wav sink
+
+    for (sInt i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (!strcmp(arg, "--about"))
+        {
+            print_about();
+            return 0;
+        }
+        else if (!strcmp(arg, "--help"))
+        {
+            print_usage(argv[0]);
+            return 0;
+        }
+        else if (!strcmp(arg, "--raw"))
+            ropt.Raw = 1;
+        else if (!strcmp(arg, "--dither"))
+            ropt.Dither = 1;
+        else if (!strcmp(arg, "--pipeline"))
+            ropt.Pipelined = 1;
+        else if (!strcmp(arg, "--blocking"))
+            blocking = 1;
+        else if (!strcmp(arg, "--stats"))
+            stats = 1;
+        else if (!strcmp(arg, "--dump-headroom") && value)
+            dump_name = argv[++i];
+        else if (!strcmp(arg, "--render") && value)
+            render_name = argv[++i];
+        else if (!strcmp(arg, "--batch") && value)
+            batch_source = argv[++i];
+        else if (!strcmp(arg, "--outdir") && value)
+            bopt.OutDir = argv[++i];
+        else if (!strcmp(arg, "--threads") && value)
+            ropt.Threads = sMax(atoi(argv[++i]), 0);
+        else if (!strcmp(arg, "--fir-threads") && value)
+            ropt.FIRThreads = sMax(atoi(argv[++i]), 0);
+        else if (!strcmp(arg, "--buffer") && value)
+            buffer_frames = sClamp(atoi(argv[++i]), 16, FRAMES_PER_BUFFER);
+        else if (!strcmp(arg, "--sink") && value)
+        {
+            sink_type = sink_parse(argv[++i]);
+            if (sink_type < 0)
+            {
+                fprintf(stderr, "Error: Unknown sink '%s'\n", value);
+                return 1;
+            }
+            if (sink_type == SINK_WAV)
+            {
+                if (i + 1 >= argc)
+                {
+                    print_usage(argv[0]);
+                    return 1;
+                }
+                sink_name = argv[++i];
+            }
+        }
+        else if (!strcmp(arg, "--latency") && value)
+            latency_ms = sMax<sF32>(atof(argv[++i]), 0);
+        else if (!strcmp(arg, "--ahead") && value)
+            ahead_seconds = sClamp<sF32>(atof(argv[++i]), 0, 600);
+        else if (!strcmp(arg, "--jobs") && value)
+            bopt.Jobs = sMax(atoi(argv[++i]), 0);
+        else if (!strcmp(arg, "--cache") && value)
+            bopt.CacheBytes = size_t(sMax(atoi(argv[++i]), 0)) << 20;
+        else if (!strcmp(arg, "--format") && value)
+        {
+            ropt.Format = format_parse(argv[++i]);
+            if (ropt.Format < 0)
+            {
+                fprintf(stderr, "Error: Unknown sample format '%s'\n", value);
+                return 1;
+            }
+        }
+        else if (!strcmp(arg, "--loops") && value)
+            loops = sMax(atoi(argv[++i]), 0);
+        else if (!strcmp(arg, "--fade") && value)
+            ropt.FadeSeconds = sMax<sF32>(atof(argv[++i]), 0);
+        else if (!strcmp(arg, "--seconds") && value)
+            ropt.MaxSeconds = sMax<sF32>(atof(argv[++i]), 0);
+        else if ((!strcmp(arg, "--mute") || !strcmp(arg, "--solo")) && value)
+        {
+            sInt mask = parse_channels(argv[++i]);
+            if (mask < 0)
+            {
+                fprintf(stderr, "Error: Invalid channel list '%s'\n", value);
+                return 1;
+            }
+            if (!strcmp(arg, "--solo"))
+                ropt.Mute = ~mask & ((1 << MOD_CHANNELS) - 1);
+            else
+                ropt.Mute |= mask;
+        }
+        else if (arg[0] == '-' && arg[1])
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+        else if (!playlist_add(list, arg))
+            return 1;
+    }
+
+    // === Batch Processing ===
+    if (batch_source)
+    {
+        if (loops >= 0)
+            ropt.Loops = loops;
+        bopt.Render = ropt;
+        bopt.Render.Threads = 1;           // Parallelism comes from the jobs
+        bopt.Render.FIRThreads = 1;
+        bopt.Render.Pipelined = 0;
+        return batch_run(batch_source, bopt);
+    }
+
+    if (!list.Count)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    // === Offline Rendering ===
+    if (render_name)
+    {
+        if (list.Count != 1)
+        {
+            fprintf(stderr, "Error: --render takes a single MOD file\n");
+            return 1;
+        }
+        if (loops >= 0)
+            ropt.Loops = loops;
+        return render_mode(list.Paths[0], render_name, ropt, stats);
+    }
+
+    // === Load MOD File ===
+    // Status goes to stderr when the audio itself goes to stdout
+    FILE *msg = sink_type == SINK_STDOUT ? stderr : stdout;
+    fprintf(msg, "Loading MOD file: %s\n", list.Paths[0]);
+    if (list.Count > 1)
+        fprintf(msg, "Playlist: %d tracks\n", list.Count);
+
+    // Playlist tracks play once by default, a single module loops forever
+    // Later tracks are loaded in the background while the first one plays
+    sInt track_loops = loops >= 0 ? loops : (list.Count > 1 ? 1 : 0);
+    PlaylistPlayer source(list, ropt, track_loops, bopt.CacheBytes);
+    if (!source.Start())
+    {
+        fprintf(stderr, "Error: Failed to load MOD file\n");
+        playlist_free(list);
+        return 1;
+    }
+
+    const TrackInfo &first = source.GetInfo(source.GetCurrent());
+    fprintf(msg, "Loaded %zu bytes (%zu bytes of repeated sample loops)\n", first.Size, first.Padding);
+
+    // === Set Up Audio Output ===
+    // Headless sinks never touch PortAudio (but still use its Pa_Sleep)
+    AudioSink *sink = NULL;
+    PaStreamParameters outputParameters;
+    if (sink_type == SINK_PORTAUDIO)
+    {
+        printf("Initializing PortAudio...\n");
+        PaError err = Pa_Initialize();
+        if (err != paNoError)
+            handle_pa_error(err);
+
+        // === Configure Output Stream ===
+        outputParameters.device = Pa_GetDefaultOutputDevice();
+
+        if (outputParameters.device == paNoDevice)
+        {
+            fprintf(stderr, "Error: No default output device found (try --sink null)\n");
+            Pa_Terminate();
+            return 1;
+        }
+
+        outputParameters.channelCount = 2;                 // Stereo output
+        outputParameters.sampleFormat = paFloat32;         // 32-bit float samples
+        outputParameters.suggestedLatency = latency_ms >= 0 ? latency_ms / 1000.0 :
+            Pa_GetDeviceInfo(outputParameters.device)->defaultLowOutputLatency;
+        outputParameters.hostApiSpecificStreamInfo = NULL;
+
+        if (!blocking)
+            sink = new PortAudioSink(outputParameters);
+    }
+    else if (sink_type == SINK_WAV)
+    {
+        FILE *file = fopen(sink_name, "wb");
+        if (!file)
+        {
+            perror(sink_name);
+            return 1;
+        }
+        sink = new PumpSink(0, file, 1, ropt.Format, ropt.Raw, ropt.Dither);
+    }
+    else if (sink_type == SINK_STDOUT)
+        sink = new PumpSink(0, stdout, 0, ropt.Format, ropt.Raw, ropt.Dither);
+    else
+        sink = new PumpSink(sink_type == SINK_NULL_PACED, NULL, 0, ropt.Format, ropt.Raw, ropt.Dither);
+
+    // === Display Playback Information ===
+    if (msg == stdout)
+        cls();  // Clear screen
+    fprintf(msg, "TinyMOD - Amiga MOD File Player\n");
+    fprintf(msg, "================================\n\n");
+    if (list.Count > 1)
+        fprintf(msg, "Currently playing: %s (%d/%d)\n", first.Name, source.GetCurrent() + 1, list.Count);
+    else
+        fprintf(msg, "Currently playing: %s\n", first.Name);
+    fprintf(msg, "Duration: %d seconds%s\n", sInt(ropt.MaxSeconds), list.Count > 1 ? " per track" : "");
+    fprintf(msg, "Sample rate: %d Hz (Paula: %d Hz)\n", SAMPLE_RATE_OUTPUT, SAMPLE_RATE_INTERNAL);
+    fprintf(msg, "\nPress Ctrl+C to stop\n\n");
+
+    // === Play ===
+    // One stream for the whole playlist; tracks switch inside a render call
+    fprintf(msg, "Playing...\n");
+    // (--blocking renders on the main thread, without render-ahead)
+    if (!buffer_frames)
+        buffer_frames = sink ? OUTPUT_BLOCK_FRAMES : FRAMES_PER_BUFFER / 2;
+    sInt ahead_frames = sInt(ahead_seconds * SAMPLE_RATE_OUTPUT);
+    sBool ok = sink ? play_stream(sink, source, buffer_frames, ahead_frames, stats, dump_name, msg)
+                    : play_blocking(outputParameters, source, buffer_frames, dump_name);
+
+    delete sink;
+    if (sink_type == SINK_PORTAUDIO)
+        Pa_Terminate();
 
     // === Cleanup ===
-    free(mixbuffer);
-    free(mod_data);
+    playlist_free(list);
 
-    printf("Playback complete. Goodbye!\n");
+    if (!ok)
+        return 1;
+    fprintf(msg, "Playback complete. Goodbye!\n");
     return 0;
 }
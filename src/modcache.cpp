@@ -0,0 +1,172 @@
+// =================== Module Cache Implementation ===================
+
+#include "modcache.h"
+#include "modfile.h"
+#include <stdio.h>
+#include <string.h>
+
+// 64 bit FNV-1a hash of the file contents
+static sU64 content_hash(const sU8 *data, size_t size)
+{
+    sU64 hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ data[i]) * 0x100000001b3ULL;
+    return hash;
+}
+
+// =================== ModuleCache Constructor ===================
+ModuleCache::ModuleCache(size_t budget)
+    : Head(NULL), Tail(NULL), Budget(budget), Bytes(0), Count(0), Hits(0), Misses(0), Evictions(0)
+{
+    for (sInt i = 0; i < BUCKETS; i++)
+        Buckets[i] = NULL;
+}
+
+// =================== ModuleCache Destructor ===================
+ModuleCache::~ModuleCache()
+{
+    Clear();
+}
+
+// =================== ModuleCache::Unlink ===================
+void ModuleCache::Unlink(Entry *e)
+{
+    if (e->Prev)
+        e->Prev->Next = e->Next;
+    else
+        Head = e->Next;
+    if (e->Next)
+        e->Next->Prev = e->Prev;
+    else
+        Tail = e->Prev;
+}
+
+// =================== ModuleCache::PushFront ===================
+void ModuleCache::PushFront(Entry *e)
+{
+    e->Prev = NULL;
+    e->Next = Head;
+    if (Head)
+        Head->Prev = e;
+    else
+        Tail = e;
+    Head = e;
+}
+
+// =================== ModuleCache::Trim ===================
+void ModuleCache::Trim(size_t budget)
+{
+    while (Tail && Bytes > budget)
+    {
+        Entry *e = Tail;
+        Unlink(e);
+
+        // Remove from the bucket chain
+        Entry **link = &Buckets[e->Hash & (BUCKETS - 1)];
+        while (*link != e)
+            link = &(*link)->Chain;
+        *link = e->Chain;
+
+        Bytes -= e->Cost;
+        Count--;
+        Evictions++;
+        e->Mod->Release();
+        delete e;
+    }
+}
+
+// =================== ModuleCache::Load ===================
+const Module *ModuleCache::Load(const char *filename)
+{
+    ModFile file;
+    if (!load_mod_file(filename, file))
+        return NULL;
+
+    // Hashing needs no lock; it touches the file pages the parse would
+    sU64 hash = content_hash(file.Data, file.Size);
+
+    {
+        std::lock_guard<std::mutex> guard(Lock);
+        for (Entry *e = Buckets[hash & (BUCKETS - 1)]; e; e = e->Chain)
+        {
+            // A matching hash is only a candidate: a crafted file can share
+            // it, so the contents must be the same too
+            if (e->Hash == hash && e->Size == file.Size && !memcmp(e->Mod->GetData(), file.Data, file.Size))
+            {
+                Unlink(e);
+                PushFront(e);
+                Hits++;
+                e->Mod->AddRef();
+                unload_mod_file(file);
+                return e->Mod;
+            }
+        }
+        Misses++;
+    }
+
+    // Parse outside the lock so other lookups are not held up
+    size_t size = file.Size;
+    const Module *mod = Module::Create(file);
+    if (!mod)
+    {
+        fprintf(stderr, "Error: %s is not a valid MOD file\n", filename);
+        return NULL;
+    }
+
+    // Charge the parsed module plus the file it keeps mapped and its
+    // repeated sample loops
+    size_t cost = sizeof(Module) + size + mod->GetPaddingBytes();
+
+    std::lock_guard<std::mutex> guard(Lock);
+    if (cost > Budget)
+        return mod;                        // Never fits, don't flush the cache for it
+
+    // Another thread may have parsed the same file meanwhile
+    for (Entry *e = Buckets[hash & (BUCKETS - 1)]; e; e = e->Chain)
+        if (e->Hash == hash && e->Size == size && !memcmp(e->Mod->GetData(), mod->GetData(), size))
+            return mod;
+
+    Trim(Budget - cost);
+
+    Entry *e = new Entry;
+    e->Hash = hash;
+    e->Size = size;
+    e->Cost = cost;
+    e->Mod = mod;
+    mod->AddRef();                         // One reference for the cache, one for the caller
+    e->Chain = Buckets[hash & (BUCKETS - 1)];
+    Buckets[hash & (BUCKETS - 1)] = e;
+    PushFront(e);
+    Bytes += cost;
+    Count++;
+    return mod;
+}
+
+// =================== ModuleCache::SetBudget ===================
+void ModuleCache::SetBudget(size_t budget)
+{
+    std::lock_guard<std::mutex> guard(Lock);
+    Budget = budget;
+    Trim(Budget);
+}
+
+// =================== ModuleCache::Clear ===================
+void ModuleCache::Clear()
+{
+    std::lock_guard<std::mutex> guard(Lock);
+    sU64 evictions = Evictions;
+    Trim(0);
+    Evictions = evictions;                 // Not evictions, the caller asked for it
+}
+
+// =================== ModuleCache::GetStats ===================
+void ModuleCache::GetStats(ModuleCacheStats &st)
+{
+    std::lock_guard<std::mutex> guard(Lock);
+    st.Hits = Hits;
+    st.Misses = Misses;
+    st.Evictions = Evictions;
+    st.Modules = Count;
+    st.Bytes = Bytes;
+    st.Budget = Budget;
+}
@@ -0,0 +1,80 @@
+// =================== Module Cache ===================
+// Hands out shared parsed modules, keyed by a hash of the file contents
+// A hit costs a file mapping, a hash and a comparison with the cached
+// file (hashes can be made to collide) instead of a parse; the same
+// module under different names or paths is only parsed once. Entries
+// are evicted least recently used first when the memory budget is
+// exceeded; evicted modules live on until their last player releases them.
+
+#ifndef MODCACHE_H
+#define MODCACHE_H
+
+#include <stddef.h>
+#include <mutex>
+#include "types.h"
+#include "module.h"
+
+// =================== Cache Statistics ===================
+struct ModuleCacheStats
+{
+    sU64 Hits;                             // Lookups served from the cache
+    sU64 Misses;                           // Lookups that parsed the module
+    sU64 Evictions;                        // Entries dropped to stay within the budget
+    sInt Modules;                          // Modules currently cached
+    size_t Bytes;                          // Memory charged for cached modules
+    size_t Budget;                         // Memory budget
+};
+
+// =================== ModuleCache Class ===================
+// Thread-safe; one cache can serve any number of threads
+class ModuleCache
+{
+    // Cached module, in a hash bucket chain and the LRU list
+    struct Entry
+    {
+        sU64 Hash;                         // FNV-1a hash of the file contents
+        size_t Size;                       // File size in bytes
+        size_t Cost;                       // Memory charged against the budget
+        const Module *Mod;                 // Cached module (one reference held)
+        Entry *Chain;                      // Next entry in the same bucket
+        Entry *Prev, *Next;                // LRU list neighbours (Head = most recent)
+    };
+
+    static const sInt BUCKETS = 256;       // Hash buckets (power of 2)
+
+    std::mutex Lock;                       // Guards everything below
+    Entry *Buckets[BUCKETS];               // Hash table
+    Entry *Head, *Tail;                    // LRU list
+    size_t Budget;                         // Memory budget in bytes
+    size_t Bytes;                          // Memory charged for cached modules
+    sInt Count;                            // Cached modules
+    sU64 Hits, Misses, Evictions;          // Counters
+
+    // LRU list maintenance
+    void Unlink(Entry *e);
+    void PushFront(Entry *e);
+
+    // Drop least recently used entries until Bytes <= budget
+    void Trim(size_t budget);
+
+public:
+    // budget: memory budget in bytes (0 = cache nothing, only count)
+    ModuleCache(size_t budget);
+    ~ModuleCache();
+
+    // Load a module through the cache
+    // Returns NULL on error, otherwise a module holding one reference
+    // for the caller (release it with Module::Release)
+    const Module *Load(const char *filename);
+
+    // Change the memory budget (evicts immediately if necessary)
+    void SetBudget(size_t budget);
+
+    // Drop all cached modules
+    void Clear();
+
+    // Snapshot of the counters
+    void GetStats(ModuleCacheStats &st);
+};
+
+#endif // MODCACHE_H
@@ -0,0 +1,93 @@
+// =================== MOD File Loading Implementation ===================
+
+#include "modfile.h"
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Read a whole file into heap memory (for files that cannot be mapped)
+static sU8 *read_whole_file(int fd, size_t size)
+{
+    sU8 *data = (sU8 *)malloc(size);
+    if (!data)
+    {
+        perror("malloc");
+        return NULL;
+    }
+
+    size_t done = 0;
+    while (done < size)
+    {
+        ssize_t got = read(fd, data + done, size - done);
+        if (got <= 0)
+        {
+            perror("read");
+            free(data);
+            return NULL;
+        }
+        done += got;
+    }
+    return data;
+}
+
+// =================== load_mod_file ===================
+sBool load_mod_file(const char *filename, ModFile &mod)
+{
+    mod.Data = NULL;
+    mod.Size = 0;
+    mod.Mapped = 0;
+
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1)
+    {
+        perror(filename);
+        return 0;
+    }
+
+    struct stat sb;
+    if (fstat(fd, &sb) == -1)
+    {
+        perror("fstat");
+        close(fd);
+        return 0;
+    }
+
+    // Smallest valid file: song name, 31 sample headers, order list and tag
+    if (sb.st_size < MOD_HEADER_SIZE)
+    {
+        fprintf(stderr, "Error: %s is too small to be a MOD file\n", filename);
+        close(fd);
+        return 0;
+    }
+    mod.Size = sb.st_size;
+
+    // Map read-only; the mapping stays valid after closing the descriptor
+    void *map = mmap(NULL, mod.Size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map != MAP_FAILED)
+    {
+        mod.Data = (const sU8 *)map;
+        mod.Mapped = 1;
+    }
+    else
+        mod.Data = read_whole_file(fd, mod.Size);
+
+    close(fd);
+    return mod.Data != NULL;
+}
+
+// =================== unload_mod_file ===================
+void unload_mod_file(ModFile &mod)
+{
+    if (mod.Mapped)
+        munmap((void *)mod.Data, mod.Size);
+    else
+        free((void *)mod.Data);
+
+    mod.Data = NULL;
+    mod.Size = 0;
+    mod.Mapped = 0;
+}
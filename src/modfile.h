@@ -0,0 +1,28 @@
+// =================== MOD File Loading ===================
+// Maps MOD files read-only into memory
+// Pages are only read from disk when the player touches them, and
+// processes playing the same file share them through the page cache
+
+#ifndef MODFILE_H
+#define MODFILE_H
+
+#include <stddef.h>
+#include "types.h"
+
+// =================== ModFile Structure ===================
+struct ModFile
+{
+    const sU8 *Data;                       // File contents (read only)
+    size_t Size;                           // File size in bytes
+    sBool Mapped;                          // Data is a mapping (else heap memory)
+};
+
+// Map a MOD file into memory (falls back to reading it if the file
+// cannot be mapped, e.g. a pipe)
+// Returns false on error; release the file with unload_mod_file()
+sBool load_mod_file(const char *filename, ModFile &mod);
+
+// Release a loaded MOD file
+void unload_mod_file(ModFile &mod);
+
+#endif // MODFILE_H
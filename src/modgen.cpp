@@ -0,0 +1,301 @@
+// =================== Stress Module Generator Implementation ===================
+
+#include "modgen.h"
+#include "config.h"
+#include "module.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// =================== Random Numbers ===================
+// 32 bit linear congruential generator (sU32 can be wider, so the state
+// is masked to give the same sequence on every platform)
+
+static sU32 gen_next(sU32 &state)
+{
+    state = (state * 1664525 + 1013904223) & 0xffffffff;
+    return state >> 8;
+}
+
+// Uniform in 0..n-1
+static sInt gen_range(sU32 &state, sInt n)
+{
+    return sInt(gen_next(state) % sU32(n));
+}
+
+// True with a chance of percent in 100
+static sBool gen_chance(sU32 &state, sInt percent)
+{
+    return gen_range(state, 100) < percent;
+}
+
+// =================== Effect Table ===================
+struct GenEffect
+{
+    const char *Name;
+    sInt Mask;
+};
+
+static const GenEffect Effects[] = {
+    { "arpeggio",   MODGEN_ARPEGGIO },
+    { "slide",      MODGEN_SLIDE },
+    { "portamento", MODGEN_PORTAMENTO },
+    { "vibrato",    MODGEN_VIBRATO },
+    { "tremolo",    MODGEN_TREMOLO },
+    { "volslide",   MODGEN_VOLSLIDE },
+    { "retrigger",  MODGEN_RETRIGGER },
+    { "cut",        MODGEN_CUT },
+    { "delay",      MODGEN_DELAY },
+};
+static const sInt EFFECT_COUNT = sInt(sizeof(Effects) / sizeof(Effects[0]));
+
+// Effect command and parameter for one event
+static void gen_effect(sU32 &rnd, sInt effect, sInt speed, sInt &fx, sInt &parm)
+{
+    switch (effect)
+    {
+    case MODGEN_ARPEGGIO:
+        fx = 0x0;
+        parm = ((1 + gen_range(rnd, 15)) << 4) | (1 + gen_range(rnd, 15));
+        break;
+    case MODGEN_SLIDE:
+        fx = 1 + gen_range(rnd, 2);
+        parm = 1 + gen_range(rnd, 8);
+        break;
+    case MODGEN_PORTAMENTO:
+        fx = 0x3;
+        parm = 1 + gen_range(rnd, 32);
+        break;
+    case MODGEN_VIBRATO:
+    case MODGEN_TREMOLO:
+        fx = effect == MODGEN_VIBRATO ? 0x4 : 0x7;
+        parm = ((1 + gen_range(rnd, 15)) << 4) | (1 + gen_range(rnd, 15));
+        break;
+    case MODGEN_VOLSLIDE:
+        fx = 0xa;
+        parm = (1 + gen_range(rnd, 15)) << (gen_range(rnd, 2) ? 4 : 0);
+        break;
+    case MODGEN_RETRIGGER:
+        fx = 0xe;
+        parm = 0x90 | (1 + gen_range(rnd, 2));   // Every tick or every other tick
+        break;
+    case MODGEN_CUT:
+        fx = 0xe;
+        parm = 0xc0 | (1 + gen_range(rnd, 15));
+        break;
+    default:  // MODGEN_DELAY (within the row, so the note still plays)
+        fx = 0xe;
+        parm = 0xd0 | (1 + gen_range(rnd, sMax(speed - 1, 1)));
+        break;
+    }
+}
+
+// =================== modgen_defaults ===================
+void modgen_defaults(ModGenOptions &opt)
+{
+    opt.Channels = 4;
+    opt.PeriodMin = 113;
+    opt.PeriodMax = 113;
+    opt.NoteDensity = 100;
+    opt.EffectDensity = 100;
+    opt.Effects = MODGEN_WORST;
+    opt.Samples = 4;
+    opt.SampleLen = 64;
+    opt.LoopLen = 4;
+    opt.Patterns = 8;
+    opt.Speed = 6;
+    opt.Tempo = 255;
+    opt.Seed = 1;
+}
+
+// =================== modgen_validate ===================
+sBool modgen_validate(const ModGenOptions &opt)
+{
+    const char *err = NULL;
+    sBool periods = 0;
+    for (sInt i = 1; i <= 60; i++)
+        periods |= Module::BasePTable[i] >= opt.PeriodMin && Module::BasePTable[i] <= opt.PeriodMax;
+
+    if (opt.Channels < 0 || opt.Channels > 4)
+        err = "channels must be 0-4";
+    else if (!periods)
+        err = "no note period in the period range (57-1712)";
+    else if (opt.NoteDensity < 0 || opt.NoteDensity > 100 || opt.EffectDensity < 0 || opt.EffectDensity > 100)
+        err = "densities must be 0-100 percent";
+    else if (opt.EffectDensity > 0 && !(opt.Effects & MODGEN_ALL))
+        err = "no effects to choose from";
+    else if (opt.Samples < 1 || opt.Samples > MOD_SAMPLES - 1)
+        err = "samples must be 1-31";
+    else if (opt.SampleLen < 4 || opt.SampleLen > 0x1fffe || (opt.SampleLen & 1))
+        err = "sample length must be even and 4-131070 bytes";
+    else if (opt.LoopLen < 0 || opt.LoopLen > opt.SampleLen || (opt.LoopLen & 1) || opt.LoopLen == 2)
+        err = "loop length must be even, 4 bytes up to the sample length, or 0 (a 2 byte loop means no loop in MOD)";
+    else if (opt.Patterns < 1 || opt.Patterns > 64)
+        err = "patterns must be 1-64";
+    else if (opt.Speed < 1 || opt.Speed > 32)
+        err = "speed must be 1-32";
+    else if (opt.Tempo < 33 || opt.Tempo > 255)
+        err = "tempo must be 33-255";
+
+    if (err)
+        fprintf(stderr, "Error: %s\n", err);
+    return !err;
+}
+
+// =================== modgen_parse_effects ===================
+sBool modgen_parse_effects(const char *list, sInt &mask)
+{
+    mask = 0;
+    while (*list)
+    {
+        size_t len = strcspn(list, ",");
+        sInt found = 0;
+        if (len == 3 && !strncmp(list, "all", 3))
+            found = MODGEN_ALL;
+        for (sInt i = 0; i < EFFECT_COUNT && !found; i++)
+        {
+            if (strlen(Effects[i].Name) == len && !strncmp(list, Effects[i].Name, len))
+                found = Effects[i].Mask;
+        }
+        if (!found)
+            return 0;
+        mask |= found;
+        list += len;
+        if (*list == ',')
+            list++;
+    }
+    return 1;
+}
+
+// =================== modgen_build ===================
+sU8 *modgen_build(const ModGenOptions &opt, size_t &size)
+{
+    if (!modgen_validate(opt))
+        return NULL;
+
+    size = size_t(MOD_HEADER_SIZE) + size_t(opt.Patterns) * MOD_PATTERN_SIZE + size_t(opt.Samples) * opt.SampleLen;
+    sU8 *data = (sU8 *)calloc(1, size);
+    if (!data)
+        return NULL;
+    sU32 rnd = opt.Seed;
+
+    // Note periods and effects to draw from
+    sInt periods[60], nperiods = 0;
+    for (sInt i = 1; i <= 60; i++)
+    {
+        if (Module::BasePTable[i] >= opt.PeriodMin && Module::BasePTable[i] <= opt.PeriodMax)
+            periods[nperiods++] = Module::BasePTable[i];
+    }
+    sInt effects[EFFECT_COUNT], neffects = 0;
+    for (sInt i = 0; i < EFFECT_COUNT; i++)
+    {
+        if (opt.Effects & Effects[i].Mask)
+            effects[neffects++] = Effects[i].Mask;
+    }
+
+    // === Header ===
+    snprintf((char *)data, 20, "tinymod stress %lu", (unsigned long)opt.Seed);
+    sInt loopstart = opt.LoopLen ? (opt.SampleLen - opt.LoopLen) / 2 : 0;
+    sInt looplen = opt.LoopLen ? opt.LoopLen / 2 : 1;
+    for (sInt s = 0; s < opt.Samples; s++)
+    {
+        sU8 *sh = data + 20 + s * MOD_SAMPLE_HEADER_SIZE;
+        snprintf((char *)sh, 22, "stress %d", s + 1);
+        sh[22] = sU8((opt.SampleLen / 2) >> 8);
+        sh[23] = sU8(opt.SampleLen / 2);
+        sh[25] = 64;
+        sh[26] = sU8(loopstart >> 8);
+        sh[27] = sU8(loopstart);
+        sh[28] = sU8(looplen >> 8);
+        sh[29] = sU8(looplen);
+    }
+
+    data[950] = sU8(opt.Patterns);
+    data[951] = 127;
+    for (sInt i = 0; i < opt.Patterns; i++)
+        data[952 + i] = sU8(i);
+    memcpy(data + 1080, "M.K.", 4);
+
+    // === Patterns ===
+    sU8 *ev = data + MOD_HEADER_SIZE;
+    for (sInt p = 0; p < opt.Patterns; p++)
+    {
+        for (sInt row = 0; row < 64; row++)
+        {
+            for (sInt ch = 0; ch < 4; ch++, ev += 4)
+            {
+                sInt sample = 0, period = 0, fx = 0, parm = 0;
+                if (ch < opt.Channels)
+                {
+                    if (gen_chance(rnd, opt.NoteDensity))
+                    {
+                        sample = 1 + gen_range(rnd, opt.Samples);
+                        period = periods[gen_range(rnd, nperiods)];
+                    }
+                    if (neffects && gen_chance(rnd, opt.EffectDensity))
+                        gen_effect(rnd, effects[gen_range(rnd, neffects)], opt.Speed, fx, parm);
+                }
+
+                // Speed and tempo are set on the first row (the last two channels)
+                if (!p && !row && ch == 3 && opt.Speed != 6)
+                    fx = 0xf, parm = opt.Speed;
+                if (!p && !row && ch == 2 && opt.Tempo != 125)
+                    fx = 0xf, parm = opt.Tempo;
+
+                ev[0] = sU8((sample & 0xf0) | (period >> 8));
+                ev[1] = sU8(period);
+                ev[2] = sU8(((sample & 0x0f) << 4) | fx);
+                ev[3] = sU8(parm);
+            }
+        }
+    }
+
+    // === Sample Data ===
+    // Saw, square and noise, so looped voices never sit at a constant value
+    // (at 3/8 of full scale: two voices per side plus FIR overshoot stay
+    // below clipping, so integer output can still be checked for rounding)
+    sS8 *smp = (sS8 *)ev;
+    for (sInt s = 0; s < opt.Samples; s++)
+    {
+        for (sInt i = 0; i < opt.SampleLen; i++)
+        {
+            sInt v;
+            switch (s % 3)
+            {
+            case 0:  v = (i * 37) & 0xff; break;
+            case 1:  v = (i & 2) ? 0xff : 0x00; break;
+            default: v = sInt(gen_next(rnd) & 0xff); break;
+            }
+            *smp++ = sS8((v - 128) * 3 / 8);
+        }
+
+        // One-shot samples end on silence, like tracker-made ones
+        if (!opt.LoopLen)
+            smp[-1] = smp[-2] = 0;
+    }
+
+    return data;
+}
+
+// =================== modgen_write ===================
+sBool modgen_write(const ModGenOptions &opt, const char *filename)
+{
+    size_t size;
+    sU8 *data = modgen_build(opt, size);
+    if (!data)
+        return 0;
+
+    FILE *fh = fopen(filename, "wb");
+    if (!fh)
+    {
+        perror(filename);
+        free(data);
+        return 0;
+    }
+    sBool ok = fwrite(data, 1, size, fh) == size;
+    ok = (fclose(fh) == 0) && ok;
+    if (!ok)
+        fprintf(stderr, "Error: Failed to write %s\n", filename);
+    free(data);
+    return ok;
+}
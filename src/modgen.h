@@ -0,0 +1,71 @@
+// =================== Stress Module Generator ===================
+// Builds synthetic 4 channel M.K. modules with a chosen render load:
+// how many channels play, which periods the notes use, how often rows
+// trigger notes and carry effects, which effects, how short the sample
+// loops are and how many patterns the song has. The defaults are the
+// worst case for the player: every channel at period 113 on every row,
+// with arpeggio, vibrato or retrigger on each note and tiny loops.
+// Output depends only on the options (a seeded generator, integer math),
+// so benchmark and golden inputs are reproducible on any machine.
+
+#ifndef MODGEN_H
+#define MODGEN_H
+
+#include <stddef.h>
+#include "types.h"
+
+// =================== Effects ===================
+// Bit mask of the effects notes are given
+enum ModGenEffect
+{
+    MODGEN_ARPEGGIO   = 0x0001,            // 0xy
+    MODGEN_SLIDE      = 0x0002,            // 1xx / 2xx
+    MODGEN_PORTAMENTO = 0x0004,            // 3xx
+    MODGEN_VIBRATO    = 0x0008,            // 4xy
+    MODGEN_TREMOLO    = 0x0010,            // 7xy
+    MODGEN_VOLSLIDE   = 0x0020,            // Axy
+    MODGEN_RETRIGGER  = 0x0040,            // E9x
+    MODGEN_CUT        = 0x0080,            // ECx
+    MODGEN_DELAY      = 0x0100,            // EDx
+    MODGEN_ALL        = 0x01ff,
+
+    MODGEN_WORST      = MODGEN_ARPEGGIO | MODGEN_VIBRATO | MODGEN_RETRIGGER,
+};
+
+// =================== Generator Options ===================
+struct ModGenOptions
+{
+    sInt Channels;                         // Channels that play notes (0-4)
+    sInt PeriodMin;                        // Note periods are drawn evenly from the period
+    sInt PeriodMax;                        // table entries in this range (57-1712)
+    sInt NoteDensity;                      // Percentage of rows that trigger a note
+    sInt EffectDensity;                    // Percentage of notes with an effect
+    sInt Effects;                          // Effects to choose from (ModGenEffect mask)
+    sInt Samples;                          // Instruments (1-31)
+    sInt SampleLen;                        // Sample length in bytes (even, 4-131070)
+    sInt LoopLen;                          // Loop length in bytes at the sample end (even, 0 = one-shot)
+    sInt Patterns;                         // Patterns, played once each in order (1-64)
+    sInt Speed;                            // Ticks per row (1-32)
+    sInt Tempo;                            // BPM (33-255)
+    sU32 Seed;                             // Random seed
+};
+
+// Worst-case load (see above)
+void modgen_defaults(ModGenOptions &opt);
+
+// Check the options, printing the first problem to stderr
+sBool modgen_validate(const ModGenOptions &opt);
+
+// Parse an effect list such as "arpeggio,vibrato,retrigger" or "all"
+// Returns false on an unknown name
+sBool modgen_parse_effects(const char *list, sInt &mask);
+
+// Build the module file image
+// Returns NULL if the options are invalid, otherwise a malloc()ed image
+sU8 *modgen_build(const ModGenOptions &opt, size_t &size);
+
+// Build the module and write it to a file
+// Returns false on invalid options or write errors
+sBool modgen_write(const ModGenOptions &opt, const char *filename);
+
+#endif // MODGEN_H
@@ -0,0 +1,113 @@
+// =================== TinyMOD Stress Module Generator ===================
+// Writes synthetic M.K. modules for worst-case performance testing.
+// Without options the module is the worst case (see modgen.h); every
+// option dials one part of the load down or changes its shape.
+//
+// Build with "make modgen":
+//   ./tinymod_modgen [OPTIONS] <output.mod>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "types.h"
+#include "modgen.h"
+
+static void print_usage(const char *program_name)
+{
+    ModGenOptions def;
+    modgen_defaults(def);
+
+    printf("Usage: %s [OPTIONS] <output.mod>\n\n", program_name);
+    printf("Writes a 4 channel M.K. module with a synthetic render load\n");
+    printf("(default: the worst case).\n\n");
+    printf("OPTIONS:\n");
+    printf("  --channels <n>      Channels playing notes, 0-4 (default %d)\n", def.Channels);
+    printf("  --period <lo>[-<hi>]\n");
+    printf("                      Note periods drawn from this range, 57-1712 (default %d)\n", def.PeriodMin);
+    printf("  --notes <percent>   Rows that trigger a note (default %d)\n", def.NoteDensity);
+    printf("  --effects <percent> Notes that carry an effect (default %d)\n", def.EffectDensity);
+    printf("  --fx <list>         Effects to use, comma separated (default arpeggio,vibrato,retrigger):\n");
+    printf("                      arpeggio, slide, portamento, vibrato, tremolo, volslide,\n");
+    printf("                      retrigger, cut, delay, all\n");
+    printf("  --samples <n>       Instruments, 1-31 (default %d)\n", def.Samples);
+    printf("  --sample-len <n>    Sample length in bytes (default %d)\n", def.SampleLen);
+    printf("  --loop <n>          Loop length in bytes at the sample end, 0 = one-shot (default %d)\n", def.LoopLen);
+    printf("  --patterns <n>      Patterns, 1-64 (default %d)\n", def.Patterns);
+    printf("  --speed <n>         Ticks per row (default %d)\n", def.Speed);
+    printf("  --tempo <bpm>       Tempo (default %d)\n", def.Tempo);
+    printf("  --seed <n>          Random seed (default %lu)\n", (unsigned long)def.Seed);
+    printf("  --help              Display this help message\n");
+}
+
+// =================== Main Program ===================
+int main(int argc, const char **argv)
+{
+    ModGenOptions opt;
+    modgen_defaults(opt);
+    const char *outname = NULL;
+
+    for (sInt i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (!strcmp(arg, "--help"))
+        {
+            print_usage(argv[0]);
+            return 0;
+        }
+        else if (!strcmp(arg, "--channels") && value)
+            opt.Channels = atoi(argv[++i]);
+        else if (!strcmp(arg, "--period") && value)
+        {
+            const char *dash = strchr(argv[++i], '-');
+            opt.PeriodMin = atoi(argv[i]);
+            opt.PeriodMax = dash ? atoi(dash + 1) : opt.PeriodMin;
+        }
+        else if (!strcmp(arg, "--notes") && value)
+            opt.NoteDensity = atoi(argv[++i]);
+        else if (!strcmp(arg, "--effects") && value)
+            opt.EffectDensity = atoi(argv[++i]);
+        else if (!strcmp(arg, "--fx") && value)
+        {
+            if (!modgen_parse_effects(argv[++i], opt.Effects))
+            {
+                fprintf(stderr, "Error: Unknown effect in '%s'\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (!strcmp(arg, "--samples") && value)
+            opt.Samples = atoi(argv[++i]);
+        else if (!strcmp(arg, "--sample-len") && value)
+            opt.SampleLen = atoi(argv[++i]);
+        else if (!strcmp(arg, "--loop") && value)
+            opt.LoopLen = atoi(argv[++i]);
+        else if (!strcmp(arg, "--patterns") && value)
+            opt.Patterns = atoi(argv[++i]);
+        else if (!strcmp(arg, "--speed") && value)
+            opt.Speed = atoi(argv[++i]);
+        else if (!strcmp(arg, "--tempo") && value)
+            opt.Tempo = atoi(argv[++i]);
+        else if (!strcmp(arg, "--seed") && value)
+            opt.Seed = sU32(strtoul(argv[++i], NULL, 0));
+        else if ((arg[0] == '-' && arg[1]) || outname)
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+        else
+            outname = arg;
+    }
+
+    if (!outname)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    if (!modgen_write(opt, outname))
+        return 1;
+    printf("Wrote %s\n", outname);
+    return 0;
+}
@@ -1,99 +1,18 @@
 // =================== MOD File Player Implementation ===================
-// Implementation of MOD file parsing and playback
+// Implementation of MOD playback (parsing lives in module.cpp)
 
 #include "modplayer.h"
+#include "pcm.h"
+#include "stats.h"
+#include "trace.h"
 #include <cstring>
 #include <cstdlib>
 
 // =================== Static Data Initialization ===================
-// Base period table for MOD format
-// Period values define the playback rate (frequency) of samples
-// Lower period = higher frequency = higher pitch
-sInt ModPlayer::BasePTable[61] = {
-    0,  // Dummy entry
-    // C-0 to B-0 (Octave 0)
-    1712, 1616, 1525, 1440, 1357, 1281, 1209, 1141, 1077, 1017, 961, 907,
-    // C-1 to B-1 (Octave 1)
-    856,  808,  762,  720,  678,  640,  604,  570,  538,  508, 480, 453,
-    // C-2 to B-2 (Octave 2)
-    428,  404,  381,  360,  339,  320,  302,  285,  269,  254, 240, 226,
-    // C-3 to B-3 (Octave 3)
-    214,  202,  190,  180,  170,  160,  151,  143,  135,  127, 120, 113,
-    // C-4 to B-4 (Octave 4)
-    107,  101,   95,   90,   85,   80,   76,   71,   67,   64,  60,  57,
-};
-
 // Period and vibrato tables (filled in by constructor)
 sInt ModPlayer::PTable[16][60];
 sInt ModPlayer::VibTable[3][15][64];
 
-// =================== Sample::Prepare ===================
-void ModPlayer::Sample::Prepare()
-{
-    // MOD files store multi-byte values in big-endian format
-    // Convert to native byte order (usually little-endian on modern systems)
-    sSwapEndian(Length);                   // 16-bit value: swap bytes
-    sSwapEndian(LoopStart);                // 16-bit value: swap bytes
-    sSwapEndian(LoopLen);                  // 16-bit value: swap bytes
-
-    // Clamp finetune to valid range (-8 to +7)
-    Finetune &= 0x0f;                      // Keep only lower 4 bits
-    if (Finetune >= 8)
-        Finetune -= 16;                    // Convert from unsigned to signed
-}
-
-// =================== Pattern Constructor ===================
-ModPlayer::Pattern::Pattern()
-{
-    // Zero out all event data
-    sZeroMem(this, sizeof(Pattern));
-}
-
-// =================== Pattern::Load ===================
-// Parse pattern data from MOD file
-// Each note event is 4 bytes: (sample/period_hi, period_lo, effect, parameter)
-void ModPlayer::Pattern::Load(sU8 *ptr)
-{
-    for (sInt row = 0; row < 64; row++)
-    {
-        for (sInt ch = 0; ch < 4; ch++)
-        {
-            Event &e = Events[row][ch];
-
-            // Parse sample number (upper 4 bits of byte 0 + upper 4 bits of byte 2)
-            e.Sample = (ptr[0] & 0xf0) | (ptr[2] >> 4);
-
-            // Parse effect type (lower 4 bits of byte 2)
-            e.FX = ptr[2] & 0x0f;
-
-            // Parse effect parameter (byte 3)
-            e.FXParm = ptr[3];
-
-            // Parse note/period (bytes 0,1)
-            // Convert period value to note number using period table
-            e.Note = 0;
-            sInt period = (sInt(ptr[0] & 0x0f) << 8) | ptr[1];
-
-            if (period)
-            {
-                // Find closest matching note in period table
-                sInt bestd = sAbs(period - BasePTable[0]);
-                for (sInt i = 1; i <= 60; i++)
-                {
-                    sInt d = sAbs(period - BasePTable[i]);
-                    if (d < bestd)
-                    {
-                        bestd = d;
-                        e.Note = i;
-                    }
-                }
-            }
-
-            ptr += 4;  // Move to next note event
-        }
-    }
-}
-
 // =================== Chan Constructor ===================
 ModPlayer::Chan::Chan()
 {
@@ -144,7 +63,8 @@ void ModPlayer::TrigNote(sInt ch, const Pattern::Event &e)
 {
     Chan &c = Chans[ch];
     Paula::Voice &v = P->V[ch];
-    const Sample &s = Samples[c.Sample];
+    const Sample &s = Mod->Samples[c.Sample];
+    const Module::PaddedSample &pd = Mod->Padded[c.Sample];
     sInt offset = 0;
 
     // Effect 9: Sample offset
@@ -156,13 +76,14 @@ void ModPlayer::TrigNote(sInt ch, const Pattern::Event &e)
     {
         c.SetPeriod();
 
-        // Handle looping vs. one-shot samples
-        if (s.LoopLen > 1)
-            // Looping sample
-            v.Trigger(SData[c.Sample], 2 * (s.LoopStart + s.LoopLen), 2 * s.LoopLen, offset);
+        // Padded samples loop either way (one-shots on their last byte);
+        // offsets are clamped to the original sample end
+        if (pd.Data)
+            v.Trigger(pd.Data, pd.Clamp, pd.LoopLen, sMin(offset, pd.Clamp - 1), pd.Silent, pd.Loop,
+                      pd.LoopPad);
         else
-            // One-shot sample
-            v.Trigger(SData[c.Sample], v.SampleLen = 2 * s.Length, 1, offset);
+            // Empty one-shot sample
+            v.Trigger(Mod->SData[c.Sample], 2 * s.Length, 1, offset);
 
         // Reset vibrato/tremolo position unless set to "don't retrigger"
         if (!c.VibRetr)
@@ -183,6 +104,12 @@ void ModPlayer::Reset()
     CurRow = 0;
     CurPos = 0;
     Delay = 0;
+    RowPos = -1;
+
+    PlayCount = 0;
+    SongEnd = 0;
+    FadePos = -1;
+    Finished = 0;
 }
 
 // =================== ModPlayer::Tick ===================
@@ -191,9 +118,18 @@ void ModPlayer::Reset()
 // Handles note triggers, effect processing, and timing
 void ModPlayer::Tick()
 {
-    const Pattern &p = Patterns[PatternList[CurPos]];
+    const Pattern &p = Mod->Patterns[Mod->PatternList[CurPos]];
     const Pattern::Event *re = p.Events[CurRow];
 
+    TRACE_PROBE4(tick, CurPos, CurRow, CurTick, Speed);
+    if (!CurTick)
+    {
+        TRACE_PROBE3(row, CurPos, CurRow, Mod->PatternList[CurPos]);
+        if (CurPos != RowPos)
+            TRACE_PROBE2(position, CurPos, Mod->PatternList[CurPos]);
+        RowPos = CurPos;
+    }
+
     // Process each of the 4 channels
     for (sInt ch = 0; ch < 4; ch++)
     {
@@ -209,8 +145,8 @@ void ModPlayer::Tick()
             if (e.Sample)
             {
                 c.Sample = e.Sample;
-                c.FineTune = Samples[c.Sample].Finetune;
-                c.Volume = Samples[c.Sample].Volume;
+                c.FineTune = Mod->Samples[c.Sample].Finetune;
+                c.Volume = Mod->Samples[c.Sample].Volume;
             }
 
             // Store effect parameter in buffer
@@ -382,6 +318,9 @@ void ModPlayer::Tick()
             case 11:  // Position jump
                 if (CurTick == Speed - 1)
                 {
+                    // Jumping back to an earlier position restarts the song
+                    if (e.FXParm <= CurPos)
+                        SongEnd = 1;
                     CurRow = -1;
                     CurPos = e.FXParm;
                 }
@@ -457,13 +396,17 @@ void ModPlayer::Tick()
     }
 
     // Loop back to beginning when reaching end of song
-    if (CurPos >= PositionCount)
+    if (CurPos >= Mod->PositionCount)
+    {
         CurPos = 0;
+        SongEnd = 1;
+    }
 }
 
-// =================== ModPlayer Constructor ===================
-// Load and parse MOD file
-ModPlayer::ModPlayer(Paula *p, sU8 *moddata) : P(p)
+// =================== ModPlayer::InitTables ===================
+// Build the shared period and vibrato tables
+// Called exactly once, before the first ModPlayer is constructed
+sBool ModPlayer::InitTables()
 {
     // Build period table for all finetune values (-8 to +7)
     // This adjusts the base periods by fractional semitones
@@ -477,7 +420,7 @@ ModPlayer::ModPlayer(Paula *p, sU8 *moddata) : P(p)
 
         // Generate period table for this finetune
         for (sInt i = 0; i < 60; i++)
-            PTable[ft][i] = sInt(sF32(BasePTable[i]) * fac + 0.5f);
+            PTable[ft][i] = sInt(sF32(Module::BasePTable[i]) * fac + 0.5f);
     }
 
     // Build vibrato/tremolo waveform tables
@@ -498,96 +441,198 @@ ModPlayer::ModPlayer(Paula *p, sU8 *moddata) : P(p)
         }
     }
 
-    // === Parse MOD File ===
-    // Extract song name (first 20 bytes)
-    memcpy(Name, moddata, 20);
-    Name[20] = 0;  // Null terminate
-    moddata += 20;
-
-    // Initialize sample array
-    SampleCount = 32;  // Default to 32 samples
-    ChannelCount = 4;  // MOD format always has 4 channels
-    Samples = (Sample *)(moddata - sizeof(Sample));
-    moddata += 15 * sizeof(Sample);  // Skip first 15 sample headers
-
-    // Check MOD format tag (determines sample count)
-    sU32 &tag = *(sU32 *)(moddata + 130 + 16 * sizeof(Sample));
-    switch (tag)
-    {
-    case '.K.M':  // M.K. (Michael Kleps) - standard 4-channel MOD
-    case '4TLF':  // FLT4 (Startrekker 4 channel)
-    case '!K!M':  // M!K! (more than 100 patterns)
-        SampleCount = 32;  // These formats use 32 samples
-        break;
-    }
+    return 1;
+}
 
-    // Skip extra sample headers if needed
-    if (SampleCount > 16)
-        moddata += (SampleCount - 16) * sizeof(Sample);
+// =================== ModPlayer Constructor ===================
+// Start playback of a module from the beginning
+ModPlayer::ModPlayer(Paula *p, const Module *mod) : P(p), Mod(mod)
+{
+    // Shared tables are built on first use (thread-safe static init),
+    // so players can be constructed concurrently
+    static const sBool TablesReady = InitTables();
+    (void)TablesReady;
 
-    // Prepare all samples (convert from big-endian format)
-    for (sInt i = 1; i < SampleCount; i++)
-        Samples[i].Prepare();
+    Mod->AddRef();
 
-    // Load song structure
-    PositionCount = *moddata;  // Number of patterns in sequence
-    moddata += 2;              // Skip unused byte
-    memcpy(PatternList, moddata, 128);  // Load pattern order list
-    moddata += 128;
+    // Initialize playback state (loop forever by default)
+    Repeats = 0;
+    FadeLen = 0;
+    Reset();
+}
 
-    // Skip format tag if present
-    if (SampleCount > 15)
-        moddata += 4;
+// =================== ModPlayer Copy Constructor ===================
+// Snapshot of another player's state, driving a different Paula
+ModPlayer::ModPlayer(const ModPlayer &src, Paula *p)
+{
+    *this = src;
+    P = p;
+    Mod->AddRef();
+}
 
-    // Find highest pattern number used
-    PatternCount = 0;
-    for (sInt i = 0; i < 128; i++)
-        PatternCount = sMax(PatternCount, PatternList[i] + 1);
+// =================== ModPlayer Destructor ===================
+ModPlayer::~ModPlayer()
+{
+    Mod->Release();
+}
 
-    // Load all patterns
-    for (sInt i = 0; i < PatternCount; i++)
-    {
-        Patterns[i].Load(moddata);
-        moddata += 1024;  // Each pattern is 1024 bytes
-    }
+// =================== ModPlayer::GetModule ===================
+const Module *ModPlayer::GetModule() const
+{
+    return Mod;
+}
 
-    // Load sample data
-    sZeroMem(SData, sizeof(SData));
-    for (sInt i = 1; i < SampleCount; i++)
-    {
-        SData[i] = (sS8 *)moddata;
-        moddata += 2 * Samples[i].Length;  // Samples are stored as words (2 bytes)
-    }
+// =================== ModPlayer::SetLoops ===================
+void ModPlayer::SetLoops(sInt loops)
+{
+    Repeats = sMax(loops, 0);
+}
 
-    // Initialize playback state
-    Reset();
+// =================== ModPlayer::SetFadeOut ===================
+void ModPlayer::SetFadeOut(sInt frames)
+{
+    FadeLen = sMax(frames, 0);
 }
 
-// =================== ModPlayer::Render ===================
-// Generate audio samples for playback
-sU32 ModPlayer::Render(sF32 *buf, sU32 len)
+// =================== ModPlayer::IsFinished ===================
+sBool ModPlayer::IsFinished() const
 {
-    while (len)
+    return Finished;
+}
+
+// =================== ModPlayer::GetFadePos ===================
+sInt ModPlayer::GetFadePos() const
+{
+    return FadePos;
+}
+
+// =================== ModPlayer::GetFadeLen ===================
+sInt ModPlayer::GetFadeLen() const
+{
+    return FadeLen;
+}
+
+// =================== ModPlayer::SetMute ===================
+void ModPlayer::SetMute(sInt mask)
+{
+    P->MuteMask = mask & ((1 << MOD_CHANNELS) - 1);
+}
+
+// =================== ModPlayer::GetMute ===================
+sInt ModPlayer::GetMute() const
+{
+    return P->MuteMask;
+}
+
+// =================== ModPlayer::Run ===================
+// Render loop shared by Render() and Advance()
+// Stops early once the requested number of loops (and fade-out) is done
+sU32 ModPlayer::Run(sF32 *buf, sU32 len, sBool generate)
+{
+    sU32 done = 0;
+
+    while (done < len && !Finished)
     {
+        if (!TRCounter)
+        {
+            // The previous tick wrapped the song: count one pass
+            if (SongEnd)
+            {
+                SongEnd = 0;
+                if (Repeats && ++PlayCount == Repeats)
+                {
+                    if (!FadeLen)
+                    {
+                        Finished = 1;  // Stop exactly at the song end
+                        break;
+                    }
+                    FadePos = 0;       // Keep playing while fading out
+                }
+            }
+
+            // Time for next MOD tick
+            sU64 start = stats_now();
+            Tick();
+            stats_add(STATS_TICK, start, TickRate);
+            TRCounter = TickRate;  // Reset counter for next tick
+            continue;
+        }
+
         // Calculate how many samples to generate before next tick
-        sInt todo = sMin<sInt>(len, TRCounter);
+        sInt todo = sMin<sInt>(len - done, TRCounter);
+        if (FadePos >= 0)
+            todo = sMin(todo, FadeLen - FadePos);
 
-        if (todo)
-        {
-            // Render Paula audio
+        // Render Paula audio (or just advance it)
+        if (buf)
             P->Render(buf, todo);
-            buf += 2 * todo;           // Stereo: 2 samples per frame
-            len -= todo;
-            TRCounter -= todo;
-        }
         else
+            P->Advance(todo, generate);
+
+        // Apply linear fade-out gain during the tail
+        if (FadePos >= 0)
         {
-            // Time for next MOD tick
-            Tick();
-            TRCounter = TickRate;  // Reset counter for next tick
+            for (sInt i = 0; buf && i < todo; i++)
+            {
+                sF32 gain = 1.0f - sF32(FadePos + i) / sF32(FadeLen);
+                buf[2 * i] *= gain;
+                buf[2 * i + 1] *= gain;
+            }
+            FadePos += todo;
+            if (FadePos >= FadeLen)
+                Finished = 1;
         }
+
+        if (buf)
+            buf += 2 * todo;       // Stereo: 2 samples per frame
+        done += todo;
+        TRCounter -= todo;
     }
-    return 1;
+
+    // Pad the remainder with silence after the song has ended
+    if (buf && done < len)
+        sZeroMem(buf, sizeof(sF32) * 2 * (len - done));
+
+    return done;
+}
+
+// =================== ModPlayer::Render ===================
+// Generate audio samples for playback
+sU32 ModPlayer::Render(sF32 *buf, sU32 len)
+{
+    return Run(buf, len, 1);
+}
+
+// =================== ModPlayer::RenderPCM ===================
+// Each tile is converted while it is still in L1 cache
+sU32 ModPlayer::RenderPCM(void *buf, sU32 len, sInt format, PcmDither *dither)
+{
+    sF32 tile[2 * PCM_TILE_FRAMES];
+    const sInt stride = 2 * format_bytes(format);
+    sU8 *out = (sU8 *)buf;
+    sU32 done = 0;
+
+    while (done < len)
+    {
+        sU32 todo = sMin<sU32>(len - done, PCM_TILE_FRAMES);
+        sU32 frames = Run(tile, todo, 1);
+        pcm_convert(tile, out, 2 * frames, format, dither);
+        out += frames * stride;
+        done += frames;
+        if (frames < todo)
+            break;
+    }
+
+    // Silence after the end of the song
+    sZeroMem(out, (len - done) * stride);
+    return done;
+}
+
+// =================== ModPlayer::Advance ===================
+// Move playback forward without producing output
+sU32 ModPlayer::Advance(sU32 len, sBool generate)
+{
+    return Run(0, len, generate);
 }
 
 // =================== ModPlayer::RenderProxy ===================
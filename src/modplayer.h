@@ -1,6 +1,7 @@
 // =================== MOD File Player ===================
 // Plays Amiga MOD (Protracker) format music files
-// Handles all MOD format parsing, effect processing, and timing
+// Holds only the per-stream playback state (position, timing, channels);
+// the song itself is a shared, immutable Module
 
 #ifndef MODPLAYER_H
 #define MODPLAYER_H
@@ -8,6 +9,9 @@
 #include "types.h"
 #include "config.h"
 #include "paula.h"
+#include "module.h"
+
+struct PcmDither;
 
 // =================== ModPlayer Class ===================
 // Represents a MOD file player with playback control and effect processing
@@ -19,10 +23,12 @@ private:
 
     // === Period & Frequency Tables ===
     // These tables convert MOD note values to Paula periods
-    static sInt BasePTable[5 * 12 + 1];    // Base period table (5 octaves x 12 semitones + extra)
     static sInt PTable[16][60];            // Period table for each finetune (-8 to +7)
     static sInt VibTable[3][15][64];       // Vibrato/tremolo lookup tables
 
+    // Build the period and vibrato tables (once per process)
+    static sBool InitTables();
+
     // === Playback State ===
     sInt Speed;                            // Ticks per row (default 6)
     sInt TickRate;                         // Number of samples per tick
@@ -32,52 +38,20 @@ private:
     sInt CurRow;                           // Current pattern row (0-63)
     sInt CurPos;                           // Current song position (pattern index)
     sInt Delay;                            // Pattern delay in ticks
+    sInt RowPos;                           // Position of the last row started (-1 = none, for tracing)
 
-    // === Sample Storage ===
-    sS8 *SData[32];                        // Pointers to sample data
-    sInt SampleCount;                      // Number of samples in file
-    sInt ChannelCount;                     // Number of channels (always 4 for standard MOD)
-
-    // === Song Structure ===
-    sU8 PatternList[128];                  // List of which patterns to play in which order
-    sInt PositionCount;                    // Number of positions in song
-    sInt PatternCount;                     // Number of unique patterns
+    // === Song End Handling ===
+    sInt Repeats;                          // Passes through the song to play (0 = loop forever)
+    sInt PlayCount;                        // Passes completed so far
+    sBool SongEnd;                         // Set by Tick() when the sequencer wraps or jumps back
+    sInt FadeLen;                          // Fade-out tail length in frames (0 = stop at song end)
+    sInt FadePos;                          // Frames rendered into the fade-out tail (-1 = not fading)
+    sBool Finished;                        // Song (and fade-out tail) has ended
 
-    // =================== Sample Structure ===================
-    // Represents a single instrument/sample in MOD format
-    struct Sample
-    {
-        char Name[22];                     // Sample name (22 bytes in MOD format)
-        sU16 Length;                       // Sample length in words (1 word = 2 bytes)
-        sS8 Finetune;                      // Finetune value (-8 to +7)
-        sU8 Volume;                        // Default volume (0-64)
-        sU16 LoopStart;                    // Loop start position in words
-        sU16 LoopLen;                      // Loop length in words
-
-        // Convert sample data from big-endian MOD format to native format
-        // MOD files store multi-byte values in big-endian format
-        void Prepare();
-    } *Samples;                            // Pointer to sample array
-
-    // =================== Pattern Structure ===================
-    // Represents a 64-row pattern with 4 channels of note data
-    struct Pattern
-    {
-        // Single note event (one channel, one row)
-        struct Event
-        {
-            sInt Sample;                   // Sample number (0-31)
-            sInt Note;                     // Note number (0-60)
-            sInt FX;                       // Effect type (0-15)
-            sInt FXParm;                   // Effect parameter value
-        } Events[64][4];                   // 64 rows x 4 channels
-
-        // Zero out pattern data
-        Pattern();
-
-        // Parse pattern data from MOD file format
-        void Load(sU8 *ptr);
-    } Patterns[128];                       // Array of patterns
+    // === Song Data ===
+    const Module *Mod;                     // Shared immutable module (one reference held)
+    typedef Module::Sample Sample;
+    typedef Module::Pattern Pattern;
 
     // =================== Channel State Structure ===================
     // Maintains playback state for a single audio channel
@@ -129,23 +103,77 @@ private:
     // Updates effects, advances notes, handles timing
     void Tick();
 
-public:
-    // Song name from MOD file
-    char Name[21];
+    // Shared render loop: ticks, song end and fade-out handling
+    // buf: output buffer, or NULL to advance Paula without filtering
+    // generate: with buf == NULL, whether Paula fills its ring buffer
+    sU32 Run(sF32 *buf, sU32 len, sBool generate);
+
+    // Only used by the copy constructor (references are taken there)
+    ModPlayer &operator=(const ModPlayer &) = default;
 
-    // ModPlayer constructor: load and initialize MOD file
+public:
+    // ModPlayer constructor: start playing a module from the beginning
     // p: pointer to Paula emulator
-    // moddata: pointer to MOD file data in memory
-    ModPlayer(Paula *p, sU8 *moddata);
+    // mod: parsed module; the player holds a reference while it lives,
+    //      so any number of players can share one module
+    ModPlayer(Paula *p, const Module *mod);
+
+    // Copy the complete playback state of another player (shares its module)
+    // p: Paula emulator to drive (normally a copy of src's Paula)
+    ModPlayer(const ModPlayer &src, Paula *p);
+
+    ~ModPlayer();
+
+    // Module being played
+    const Module *GetModule() const;
+
+    // =================== Song End Control ===================
+    // Set how many times the song is played before it ends
+    // loops: 0 = loop forever (default), 1 = play once, N = play N times
+    void SetLoops(sInt loops);
+
+    // Set length of the fade-out tail played after the last loop
+    // frames: fade length in output frames (0 = stop exactly at song end)
+    void SetFadeOut(sInt frames);
+
+    // Returns true once the song (including any fade-out tail) has ended
+    sBool IsFinished() const;
+
+    // Frames played into the fade-out tail (-1 = not fading yet)
+    sInt GetFadePos() const;
+
+    // Fade-out tail length in frames
+    sInt GetFadeLen() const;
+
+    // =================== Channel Muting ===================
+    // Mute channels (bit i = channel i + 1, as in Paula::MuteMask)
+    // Muted channels keep playing in the sequencer and their voices keep
+    // advancing without being rendered, so unmuting continues seamlessly
+    void SetMute(sInt mask);
+
+    // Currently muted channels
+    sInt GetMute() const;
 
     // =================== Audio Rendering ===================
     // Render audio samples into buffer
     // Called repeatedly by audio system to generate sound
     // buf: output buffer for stereo samples (float, interleaved L/R)
     // len: number of samples to generate
-    // Returns: number of samples generated
+    // Returns: number of samples generated; less than len once the song
+    //          has ended, in which case the rest of buf is zero-filled
     sU32 Render(sF32 *buf, sU32 len);
 
+    // Render straight to integer PCM (SampleFormat), same contract as Render
+    // Converts in small cache-resident tiles instead of a separate pass
+    // over a full float buffer; dither may be NULL
+    sU32 RenderPCM(void *buf, sU32 len, sInt format, PcmDither *dither);
+
+    // Advance playback by len samples without producing output
+    // generate: false = sequencer and voice positions only (fast pre-scan),
+    //           true = also refill Paula's ring buffer (warm-up)
+    // Returns: number of samples advanced (less than len at the song end)
+    sU32 Advance(sU32 len, sBool generate);
+
     // Static callback function for audio systems
     // Allows this to be used as a C-style callback
     static sU32 __stdcall RenderProxy(void *parm, sF32 *buf, sU32 len);
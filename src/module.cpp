@@ -0,0 +1,332 @@
+// =================== MOD Module Implementation ===================
+// Parsing and bounds checking of MOD files into immutable modules
+
+#include "module.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// =================== Period Table ===================
+// Base period table for MOD format
+// Period values define the playback rate (frequency) of samples
+// Lower period = higher frequency = higher pitch
+const sInt Module::BasePTable[61] = {
+    0,  // Dummy entry
+    // C-0 to B-0 (Octave 0)
+    1712, 1616, 1525, 1440, 1357, 1281, 1209, 1141, 1077, 1017, 961, 907,
+    // C-1 to B-1 (Octave 1)
+    856,  808,  762,  720,  678,  640,  604,  570,  538,  508, 480, 453,
+    // C-2 to B-2 (Octave 2)
+    428,  404,  381,  360,  339,  320,  302,  285,  269,  254, 240, 226,
+    // C-3 to B-3 (Octave 3)
+    214,  202,  190,  180,  170,  160,  151,  143,  135,  127, 120, 113,
+    // C-4 to B-4 (Octave 4)
+    107,  101,   95,   90,   85,   80,   76,   71,   67,   64,  60,  57,
+};
+
+// =================== Sample::Load ===================
+void Module::Sample::Load(const sU8 *ptr)
+{
+    memcpy(Name, ptr, 22);
+
+    // MOD files store multi-byte values in big-endian format
+    Length = sU16((ptr[22] << 8) | ptr[23]);
+    Finetune = sS8(ptr[24]);
+    Volume = ptr[25];
+    LoopStart = sU16((ptr[26] << 8) | ptr[27]);
+    LoopLen = sU16((ptr[28] << 8) | ptr[29]);
+
+    // Clamp finetune to valid range (-8 to +7)
+    Finetune &= 0x0f;                      // Keep only lower 4 bits
+    if (Finetune >= 8)
+        Finetune -= 16;                    // Convert from unsigned to signed
+}
+
+// =================== Pattern Constructor ===================
+Module::Pattern::Pattern()
+{
+    // Zero out all event data
+    sZeroMem(this, sizeof(Pattern));
+}
+
+// =================== Pattern::Load ===================
+// Parse pattern data from MOD file
+// Each note event is 4 bytes: (sample/period_hi, period_lo, effect, parameter)
+void Module::Pattern::Load(const sU8 *ptr)
+{
+    for (sInt row = 0; row < 64; row++)
+    {
+        for (sInt ch = 0; ch < 4; ch++)
+        {
+            Event &e = Events[row][ch];
+
+            // Parse sample number (upper 4 bits of byte 0 + upper 4 bits of byte 2)
+            e.Sample = (ptr[0] & 0xf0) | (ptr[2] >> 4);
+            if (e.Sample >= MOD_SAMPLES)
+                e.Sample = 0;              // Out of range: keep the current sample
+
+            // Parse effect type (lower 4 bits of byte 2)
+            e.FX = ptr[2] & 0x0f;
+
+            // Parse effect parameter (byte 3)
+            e.FXParm = ptr[3];
+
+            // Parse note/period (bytes 0,1)
+            // Convert period value to note number using period table
+            e.Note = 0;
+            sInt period = (sInt(ptr[0] & 0x0f) << 8) | ptr[1];
+
+            if (period)
+            {
+                // Find closest matching note in period table
+                sInt bestd = sAbs(period - BasePTable[0]);
+                for (sInt i = 1; i <= 60; i++)
+                {
+                    sInt d = sAbs(period - BasePTable[i]);
+                    if (d < bestd)
+                    {
+                        bestd = d;
+                        e.Note = i;
+                    }
+                }
+            }
+
+            ptr += 4;  // Move to next note event
+        }
+    }
+}
+
+// =================== Module Constructor ===================
+Module::Module() : PadMem(NULL), PadSize(0), OwnsFile(0), RefCount(1)
+{
+    File.Data = NULL;
+    File.Size = 0;
+    File.Mapped = 0;
+}
+
+// =================== Module Destructor ===================
+Module::~Module()
+{
+    free(PadMem);
+    if (OwnsFile)
+        unload_mod_file(File);
+}
+
+// =================== Module::Load ===================
+const Module *Module::Load(const char *filename)
+{
+    ModFile file;
+    if (!load_mod_file(filename, file))
+        return NULL;
+
+    const Module *mod = Create(file);
+    if (!mod)
+        fprintf(stderr, "Error: %s is not a valid MOD file\n", filename);
+    return mod;
+}
+
+// =================== Module::Create ===================
+const Module *Module::Create(ModFile &file)
+{
+    Module *mod = new Module;
+    mod->File = file;
+    mod->OwnsFile = 1;
+    if (!mod->Init())
+    {
+        delete mod;
+        return NULL;
+    }
+    return mod;
+}
+
+// =================== Module::Parse ===================
+const Module *Module::Parse(const sU8 *data, size_t size)
+{
+    if (!data || size < size_t(MOD_HEADER_SIZE))
+        return NULL;
+
+    Module *mod = new Module;
+    mod->File.Data = data;
+    mod->File.Size = size;
+    if (!mod->Init())
+    {
+        delete mod;
+        return NULL;
+    }
+    return mod;
+}
+
+// =================== Module::AddRef ===================
+void Module::AddRef() const
+{
+    RefCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+// =================== Module::Release ===================
+void Module::Release() const
+{
+    // acq_rel: all users' reads happen before the delete
+    if (RefCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete this;
+}
+
+// =================== Module::GetData ===================
+const sU8 *Module::GetData() const
+{
+    return File.Data;
+}
+
+// =================== Module::GetSize ===================
+size_t Module::GetSize() const
+{
+    return File.Size;
+}
+
+// =================== Module::GetPaddingBytes ===================
+size_t Module::GetPaddingBytes() const
+{
+    return PadSize;
+}
+
+// =================== Module::Init ===================
+// Parse the MOD file; every index the player uses later is validated here
+sBool Module::Init()
+{
+    const sU8 *moddata = File.Data;
+
+    // === Parse MOD File ===
+    // The file is never written to, so it can be a read-only mapping
+    // Extract song name (first 20 bytes)
+    memcpy(Name, moddata, 20);
+    Name[20] = 0;  // Null terminate
+
+    // Initialize sample array
+    SampleCount = 32;  // Default to 32 samples
+    ChannelCount = 4;  // MOD format always has 4 channels
+
+    // Check MOD format tag (determines sample count)
+    sU32 tag;
+    memcpy(&tag, moddata + MOD_HEADER_SIZE - 4, 4);
+    switch (tag)
+    {
+    case '.K.M':  // M.K. (Michael Kleps) - standard 4-channel MOD
+    case '4TLF':  // FLT4 (Startrekker 4 channel)
+    case '!K!M':  // M!K! (more than 100 patterns)
+        SampleCount = 32;  // These formats use 32 samples
+        break;
+    }
+
+    // Parse sample headers (sample 0 means "no sample")
+    const sU8 *ptr = moddata + 20;
+    sZeroMem(Samples, sizeof(Samples));
+    for (sInt i = 1; i < SampleCount; i++)
+    {
+        Samples[i].Load(ptr);
+        ptr += MOD_SAMPLE_HEADER_SIZE;
+    }
+
+    // Load song structure (the order list only has 128 entries)
+    PositionCount = sMin<sInt>(*ptr, 128);  // Number of patterns in sequence
+    ptr += 2;                  // Skip unused byte
+    memcpy(PatternList, ptr, 128);  // Load pattern order list
+    ptr += 128;
+
+    // Skip format tag if present
+    if (SampleCount > 15)
+        ptr += 4;
+
+    // Find highest pattern number used
+    PatternCount = 0;
+    for (sInt i = 0; i < 128; i++)
+        PatternCount = sMax(PatternCount, PatternList[i] + 1);
+    if (PatternCount > MOD_PATTERNS)
+        return 0;
+
+    // Load all patterns (patterns cut off by the file end stay empty)
+    const sU8 *end = moddata + File.Size;
+    for (sInt i = 0; i < PatternCount; i++)
+    {
+        if (end - ptr >= MOD_PATTERN_SIZE)
+            Patterns[i].Load(ptr);
+        ptr += MOD_PATTERN_SIZE;
+    }
+
+    // Locate sample data, clamped to the file so truncated modules never
+    // read past the end of the data
+    sZeroMem(SData, sizeof(SData));
+    for (sInt i = 1; i < SampleCount; i++)
+    {
+        Sample &smp = Samples[i];
+        sInt avail = ptr < end ? sInt((end - ptr) / 2) : 0;   // Words left in the file
+
+        SData[i] = (const sS8 *)sMin(ptr, end);
+        smp.Length = sU16(sMin<sInt>(smp.Length, avail));
+        if (smp.LoopStart + smp.LoopLen > avail)
+            smp.LoopLen = sU16(sMax(avail - smp.LoopStart, 0));
+
+        ptr += 2 * Samples[i].Length;  // Samples are stored as words (2 bytes)
+    }
+
+    return PadSamples();
+}
+
+// =================== Module::PadSamples ===================
+// Lay out every sample as its data up to the loop end followed by more
+// copies of the loop. One-shot samples loop on their last byte, like
+// Voice::Trigger() was given a loop length of 1 before. The data up to
+// the loop end stays in the file; loops that are already long enough are
+// used in place, the rest are repeated into one block. Each repeat holds
+// fewer than SAMPLE_LOOP_MIN plus the loop length bytes.
+sBool Module::PadSamples()
+{
+    sZeroMem(Padded, sizeof(Padded));
+
+    // Original end and loop length in bytes (loop length 1 = one-shot)
+    sInt ends[MOD_SAMPLES], loops[MOD_SAMPLES], reps[MOD_SAMPLES];
+    size_t total = 0;
+    for (sInt i = 1; i < SampleCount; i++)
+    {
+        const Sample &smp = Samples[i];
+        ends[i] = smp.LoopLen > 1 ? 2 * (smp.LoopStart + smp.LoopLen) : 2 * smp.Length;
+        loops[i] = smp.LoopLen > 1 ? 2 * smp.LoopLen : 1;
+        reps[i] = (SAMPLE_LOOP_MIN + loops[i] - 1) / loops[i];
+        if (ends[i] && reps[i] > 1)
+            total += size_t(reps[i]) * loops[i];
+    }
+
+    if (total)
+    {
+        PadMem = (sS8 *)malloc(total);
+        if (!PadMem)
+            return 0;
+        PadSize = total;
+    }
+
+    sS8 *dest = PadMem;
+    for (sInt i = 1; i < SampleCount; i++)
+    {
+        PaddedSample &pd = Padded[i];
+        sInt end = ends[i], loop = loops[i];
+        if (!end)
+            continue;                      // Empty one-shot: played from SData as is
+
+        const sS8 *src = SData[i] + end - loop;
+        pd.Data = SData[i];
+        pd.Clamp = end;
+        pd.LoopLen = loop;
+        if (reps[i] > 1)
+        {
+            for (sInt r = 0; r < reps[i]; r++)
+                memcpy(dest + r * loop, src, loop);
+            pd.Loop = dest;
+            pd.LoopPad = reps[i] * loop;
+            dest += pd.LoopPad;
+        }
+
+        pd.Silent = 1;
+        for (sInt j = 0; j < loop && pd.Silent; j++)
+            pd.Silent = !src[j];
+    }
+
+    return 1;
+}
@@ -0,0 +1,137 @@
+// =================== MOD Module ===================
+// Immutable, parsed MOD file shared between any number of players
+// A module is parsed and bounds-checked once; afterwards it is never
+// written to, so players on different threads can share it freely.
+// Lifetime is managed by an atomic reference count.
+
+#ifndef MODULE_H
+#define MODULE_H
+
+#include <stddef.h>
+#include <atomic>
+#include "types.h"
+#include "config.h"
+#include "modfile.h"
+
+// =================== Module Class ===================
+class Module
+{
+public:
+    // =================== Sample Structure ===================
+    // Represents a single instrument/sample in MOD format
+    struct Sample
+    {
+        char Name[22];                     // Sample name (22 bytes in MOD format)
+        sU16 Length;                       // Sample length in words (1 word = 2 bytes)
+        sS8 Finetune;                      // Finetune value (-8 to +7)
+        sU8 Volume;                        // Default volume (0-64)
+        sU16 LoopStart;                    // Loop start position in words
+        sU16 LoopLen;                      // Loop length in words
+
+        // Parse a 30 byte sample header from the MOD file
+        // MOD files store multi-byte values in big-endian format
+        void Load(const sU8 *ptr);
+    };
+
+    // =================== Padded Sample Structure ===================
+    // Sample data prepared for playback: the loop is repeated until it is
+    // at least SAMPLE_LOOP_MIN bytes long, and a one-shot sample gets a
+    // tail repeating its last byte (what Paula keeps fetching once it has
+    // played through). Voices then wrap at most once every SAMPLE_LOOP_MIN
+    // fetches, so spans of fetches can run without wrap checks.
+    // The sample itself is played from the file data; only the repeated
+    // loop lives in a separate buffer, which a voice switches to once it
+    // reaches the original end.
+    struct PaddedSample
+    {
+        const sS8 *Data;                   // Sample data in the file (NULL = empty sample)
+        sInt Clamp;                        // Original length in bytes (sample offsets stop here)
+        sInt LoopLen;                      // Original loop length in bytes (1 = one-shot)
+        const sS8 *Loop;                   // Repeated loop (NULL = long enough, looped in place)
+        sInt LoopPad;                      // Bytes in Loop (a multiple of LoopLen)
+        sBool Silent;                      // Loop is all zero bytes
+    };
+
+    // Represents a 64-row pattern with 4 channels of note data
+    struct Pattern
+    {
+        // Single note event (one channel, one row)
+        struct Event
+        {
+            sInt Sample;                   // Sample number (0-31)
+            sInt Note;                     // Note number (0-60)
+            sInt FX;                       // Effect type (0-15)
+            sInt FXParm;                   // Effect parameter value
+        } Events[64][4];                   // 64 rows x 4 channels
+
+        // Zero out pattern data
+        Pattern();
+
+        // Parse pattern data from MOD file format
+        void Load(const sU8 *ptr);
+    };
+
+    // Base period table for MOD format (5 octaves x 12 semitones + dummy)
+    static const sInt BasePTable[5 * 12 + 1];
+
+    // === Song Data ===
+    char Name[21];                         // Song name
+    Sample Samples[MOD_SAMPLES];           // Parsed sample headers (0 = no sample)
+    const sS8 *SData[MOD_SAMPLES];         // Pointers to sample data (into the module file)
+    PaddedSample Padded[MOD_SAMPLES];      // Samples prepared for playback (see above)
+    sInt SampleCount;                      // Number of samples in file
+    sInt ChannelCount;                     // Number of channels (always 4 for standard MOD)
+    sU8 PatternList[128];                  // List of which patterns to play in which order
+    sInt PositionCount;                    // Number of positions in song (0-128)
+    sInt PatternCount;                     // Number of unique patterns
+    Pattern Patterns[MOD_PATTERNS];        // Array of patterns
+
+    // Load and parse a MOD file (the file stays mapped while the module lives)
+    // Returns NULL on error, otherwise a module holding one reference
+    static const Module *Load(const char *filename);
+
+    // Parse a file loaded with load_mod_file() and take ownership of it
+    // (the file is unloaded with the module, or right away on error)
+    // Returns NULL on error, otherwise a module holding one reference
+    static const Module *Create(ModFile &file);
+
+    // Parse a MOD file already in memory
+    // data: file contents; must outlive the module, which references the
+    //       sample data in place
+    // Returns NULL on error, otherwise a module holding one reference
+    static const Module *Parse(const sU8 *data, size_t size);
+
+    // Take an additional reference
+    void AddRef() const;
+
+    // Drop a reference; the module is freed when the last one goes
+    void Release() const;
+
+    // Raw file contents the module was parsed from
+    const sU8 *GetData() const;
+    size_t GetSize() const;
+
+    // Memory allocated for the repeated loops, in bytes (less than
+    // SAMPLE_LOOP_MIN plus the loop length per sample)
+    size_t GetPaddingBytes() const;
+
+private:
+    ModFile File;                          // Source file (Data/Size always valid)
+    sS8 *PadMem;                           // Storage of all repeated loops (malloc()ed)
+    size_t PadSize;                        // Bytes in PadMem
+    sBool OwnsFile;                        // File is unloaded with the module
+    mutable std::atomic<sInt> RefCount;    // Outstanding references
+
+    Module();
+    ~Module();
+    Module(const Module &);                // Not copyable (shared by reference)
+    Module &operator=(const Module &);
+
+    // Parse and validate File
+    sBool Init();
+
+    // Build Padded[] from the validated sample headers and SData[]
+    sBool PadSamples();
+};
+
+#endif // MODULE_H
@@ -2,7 +2,56 @@
 // Implementation of the Amiga Paula chip audio hardware emulator
 
 #include "paula.h"
+#include "threadpool.h"
+#include "stats.h"
+#include "trace.h"
 #include <cstring>
+#include <cstdlib>
+
+// =================== DAC Table ===================
+sF32 Paula::DacTable[256];
+
+// =================== Paula::SetDacWeights ===================
+void Paula::SetDacWeights(const sF64 weights[8])
+{
+    for (sInt i = 0; i < 256; i++)
+    {
+        // Bits of the offset binary code the DAC sees, centered on 128
+        sInt code = i ^ 0x80;
+        sF64 level = 0;
+        for (sInt bit = 0; bit < 8; bit++)
+            if (code & (1 << bit))
+                level += weights[bit];
+        DacTable[i] = sF32((level - 128) / 128);
+    }
+}
+
+// Ideal DAC, set up before main() so DacTable is never read uninitialized
+static struct DacInit
+{
+    DacInit()
+    {
+        static const sF64 ideal[8] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+        Paula::SetDacWeights(ideal);
+    }
+} dac_init;
+
+// =================== Voice::Wrap ===================
+inline void Paula::Voice::Wrap()
+{
+    if (!Loop)
+    {
+        Pos -= LoopLen;                    // Jump back to loop start
+        return;
+    }
+
+    // The first copy of the loop was just played from the sample data,
+    // carry on with the second one and loop over all of them from now on
+    Sample = Loop;
+    Pos = LoopLen;
+    SampleLen = LoopLen = LoopPad;
+    Loop = 0;
+}
 
 // =================== Voice::Render ===================
 // Render voice samples into output buffer using PWM
@@ -12,87 +61,281 @@ void Paula::Voice::Render(sF32 *buffer, sInt samples)
         return;  // No sample data, nothing to render
 
     sU8 *smp = (sU8 *)Sample;
-    for (sInt i = 0; i < samples; i++)
+    sInt i = 0;
+    while (i < samples)
     {
         if (!DivCnt)
         {
-            // Load next sample: convert from 8-bit unsigned to 32-bit float
-            // XOR with 0x80 converts unsigned to signed format
-            // Shift left 15 bits and OR with mantissa to create float representation
-            Cur.U32 = ((smp[Pos] ^ 0x80) << 15) | 0x40000000;
-            Cur.F32 -= 3.0f;  // Normalize to proper range
+            // Load next sample through the DAC
+            Cur = DacTable[smp[Pos]];
 
             // Advance to next sample, handle looping
             if (++Pos == SampleLen)
-                Pos -= LoopLen;  // Jump back to loop start
+            {
+                Wrap();
+                smp = (sU8 *)Sample;
+            }
 
             DivCnt = Period;  // Reset period counter
         }
 
+        // Cycles until the next fetch (or all of them if the counter
+        // already ran past zero, it never reaches zero again then)
+        sInt run = (DivCnt > 0) ? sMin(samples - i, DivCnt) : samples - i;
+        sF32 value = Cur;
+        DivCnt -= run;
+
         // PWM (Pulse Width Modulation) output
         // Only output if PWM counter is below volume level
-        if (PWMCnt < Volume)
-            buffer[i] += Cur.F32;
+        for (sInt end = i + run; i < end; i++)
+        {
+            if (PWMCnt < Volume)
+                buffer[i] += value;
+            PWMCnt = (PWMCnt + 1) & 0x3f;  // 6-bit PWM counter (0-63)
+        }
+    }
+}
 
-        PWMCnt = (PWMCnt + 1) & 0x3f;  // 6-bit PWM counter (0-63)
-        DivCnt--;  // Decrement period counter
+// =================== Voice::Skip ===================
+// Advance the voice like Render() does, but jump from one sample fetch
+// to the next instead of stepping every Paula cycle
+void Paula::Voice::Skip(sInt samples)
+{
+    if (!Sample)
+        return;  // Render() leaves idle voices untouched too
+
+    sU8 *smp = (sU8 *)Sample;
+    PWMCnt = (PWMCnt + samples) & 0x3f;
+
+    while (samples > 0)
+    {
+        if (!DivCnt)
+        {
+            // Same fetch as Render(), only the last one is kept
+            Cur = DacTable[smp[Pos]];
+
+            if (++Pos == SampleLen)
+            {
+                Wrap();
+                smp = (sU8 *)Sample;
+            }
+
+            DivCnt = Period;
+        }
+
+        // Cycles until the next fetch (or all of them if the counter
+        // already ran past zero, as Render() never fetches again then)
+        sInt run = (DivCnt > 0) ? sMin(samples, DivCnt) : samples;
+        DivCnt -= run;
+        samples -= run;
     }
 }
 
+// =================== Voice::IsIdle ===================
+sBool Paula::Voice::IsIdle() const
+{
+    if (!Sample || Volume <= 0)
+        return 1;
+
+    // Once inside a silent loop every fetch gives DacTable[0] (exactly 0
+    // unless SetDacWeights() moved the zero level)
+    return LoopSilent && Pos >= SampleLen - LoopLen && Cur == 0 && DacTable[0] == 0;
+}
+
 // =================== Voice::Trigger ===================
 // Trigger a voice to start playing a sample
-void Paula::Voice::Trigger(sS8 *smp, sInt sl, sInt ll, sInt offs)
+void Paula::Voice::Trigger(const sS8 *smp, sInt sl, sInt ll, sInt offs, sBool silent, const sS8 *loop,
+                           sInt padlen)
 {
     Sample = smp;                          // Set sample pointer
     SampleLen = sl;                        // Set sample length
     LoopLen = ll;                          // Set loop length
+    LoopSilent = silent;                   // Set silent loop flag
+    Loop = loop;                           // Set repeated loop
+    LoopPad = padlen;
     Pos = sMin(offs, SampleLen - 1);       // Set start position (clamped)
 }
 
 // =================== Paula::CalcFrag ===================
 // Generate audio fragments at Paula rate
 // This function renders all 4 voice channels into the output buffer
-void Paula::CalcFrag(sF32 *out, sInt samples)
+sInt Paula::CalcFrag(sF32 *out, sInt samples)
 {
+    sU64 start = stats_now();
+
     // Zero out output buffer (stereo: 2 channels)
     sZeroMem(out, sizeof(sF32) * samples);
     sZeroMem(out + RBSIZE, sizeof(sF32) * samples);
 
     // Render each of the 4 Paula voices
+    sInt quiet = 3;
     for (sInt i = 0; i < 4; i++)
     {
+        // Muted and idle voices would only add zeros: just advance them
+        if (IsQuiet(i))
+        {
+            V[i].Skip(samples);
+            continue;
+        }
+
         // Paula has stereo hardwired:
         // Voices 0,3 go to left channel
         // Voices 1,2 go to right channel
-        if (i == 1 || i == 2)
-            V[i].Render(out + RBSIZE, samples);  // Right channel
-        else
-            V[i].Render(out, samples);            // Left channel
+        sInt side = (i == 1 || i == 2) ? 1 : 0;
+        V[i].Render(out + side * RBSIZE, samples);
+        quiet &= ~(1 << side);
     }
+
+    stats_add(STATS_VOICES, start, samples);
+    return quiet;
+}
+
+// =================== Paula::SkipFrag ===================
+// Advance all 4 voices without rendering
+void Paula::SkipFrag(sInt samples)
+{
+    for (sInt i = 0; i < 4; i++)
+        V[i].Skip(samples);
+}
+
+// =================== Paula::IsQuiet ===================
+sBool Paula::IsQuiet(sInt i) const
+{
+    return ((MuteMask >> i) & 1) || V[i].IsIdle();
+}
+
+// =================== Paula::CalcRing ===================
+// Once the whole ring is zero and all voices are quiet, the ring already
+// holds what CalcFrag() would write
+void Paula::CalcRing(sInt pos, sInt count)
+{
+    sBool idle = ZeroRun[0] >= RBSIZE && ZeroRun[1] >= RBSIZE;
+    for (sInt i = 0; idle && i < 4; i++)
+        idle = IsQuiet(i);
+
+    if (idle)
+        SkipFrag(count);
+    else
+    {
+        sInt quiet = CalcFrag(RingBuf + pos, count);
+        for (sInt side = 0; side < 2; side++)
+            ZeroRun[side] = ((quiet >> side) & 1) ? sMin(ZeroRun[side] + count, RBSIZE) : 0;
+    }
+
+    if (CalcHook)
+        CalcHook(CalcHookParm, this, pos, count);
 }
 
 // =================== Paula::Calc ===================
 // Fill ring buffer with new samples at Paula rate
-void Paula::Calc()
+void Paula::Calc(sBool generate)
 {
     // Calculate number of samples needed
     sInt RealReadPos = ReadPos - FIR_WIDTH - 1;
     sInt samples = (RealReadPos - WritePos) & (RBSIZE - 1);
 
+    TRACE_PROBE3(calc, WritePos, samples, generate);
+
     // Generate samples in two chunks if wrapping around ring buffer
     sInt todo = sMin(samples, RBSIZE - WritePos);
-    CalcFrag(RingBuf + WritePos, todo);
+    if (generate)
+        CalcRing(WritePos, todo);
+    else
+        SkipFrag(todo);
 
     if (todo < samples)
     {
         WritePos = 0;
         todo = samples - todo;
-        CalcFrag(RingBuf, todo);
+        if (generate)
+            CalcRing(0, todo);
+        else
+            SkipFrag(todo);
     }
 
+    // Skipped samples leave stale data in the ring
+    if (!generate)
+        ZeroRun[0] = ZeroRun[1] = 0;
     WritePos += todo;
 }
 
+// =================== FilterFrame ===================
+// FIR filter and mix for one output frame (shared by the serial and the
+// parallel path so both produce bit-identical results)
+// buf: Paula-rate samples, left channel at buf[i], right at buf[i + right]
+// offs: index of the first tap, mask: index wrap mask
+static inline void FilterFrame(const sF32 *buf, sInt offs, sInt mask, sInt right, const sF32 *fir,
+                               sF32 frac, sF32 vm0, sF32 vm1, sF32 *outbuf)
+{
+    // FIR filter: convolution with filter coefficients
+    sF32 outl0 = 0, outl1 = 0;             // Left channel (two taps for interpolation)
+    sF32 outr0 = 0, outr1 = 0;             // Right channel
+
+    // Load first sample pair
+    sF32 vl = buf[offs];
+    sF32 vr = buf[offs + right];
+
+    // Convolve with FIR filter coefficients
+    for (sInt i = 1; i < 2 * Paula::FIR_WIDTH - 1; i++)
+    {
+        sF32 w = fir[i];                // FIR coefficient
+        outl0 += vl * w;                // Accumulate left channel tap 0
+        outr0 += vr * w;                // Accumulate right channel tap 0
+
+        // Advance to next sample
+        offs = (offs + 1) & mask;
+        vl = buf[offs];
+        vr = buf[offs + right];
+
+        outl1 += vl * w;                // Accumulate left channel tap 1
+        outr1 += vr * w;                // Accumulate right channel tap 1
+    }
+
+    // Linear interpolation between two filter taps
+    sF32 outl = sLerp(outl0, outl1, frac);
+    sF32 outr = sLerp(outr0, outr1, frac);
+
+    // Apply panning and output (constant power stereo mixing)
+    outbuf[0] = vm0 * outl + vm1 * outr;  // Output sample (mixed)
+    outbuf[1] = vm1 * outl + vm0 * outr;  // Swapped for stereo separation
+}
+
+// =================== FilterChannel ===================
+// One channel of FilterFrame() (same accumulation, so mixing its result
+// with an exact 0 for the other side matches FilterFrame() bit for bit)
+static inline sF32 FilterChannel(const sF32 *buf, sInt offs, sInt mask, const sF32 *fir, sF32 frac)
+{
+    sF32 out0 = 0, out1 = 0;
+    sF32 v = buf[offs];
+
+    for (sInt i = 1; i < 2 * Paula::FIR_WIDTH - 1; i++)
+    {
+        sF32 w = fir[i];
+        out0 += v * w;
+        offs = (offs + 1) & mask;
+        v = buf[offs];
+        out1 += v * w;
+    }
+
+    return sLerp(out0, out1, frac);
+}
+
+// =================== Paula::UpdateGains ===================
+// Maintains constant power panning: vol_L^2 + vol_R^2 = constant
+// The square roots are only taken again when volume or separation
+// change, so even tiny Render() calls stay cheap
+void Paula::UpdateGains()
+{
+    if (MasterVolume == GainVolume && MasterSeparation == GainSeparation)
+        return;
+
+    const sF32 pan = 0.5f + 0.5f * MasterSeparation;
+    Gain0 = MasterVolume * sFSqrt(pan);
+    Gain1 = MasterVolume * sFSqrt(1 - pan);
+    GainVolume = MasterVolume;
+    GainSeparation = MasterSeparation;
+}
+
 // =================== Paula::Render ===================
 // Resample from Paula rate (3.74 MHz) to output rate (48 KHz)
 // Uses windowed-sinc FIR filtering for high-quality resampling
@@ -101,11 +344,24 @@ void Paula::Render(sF32 *outbuf, sInt samples)
     // Calculate resampling ratio
     const sF32 step = sF32(PAULARATE) / sF32(OUTRATE);  // ~77.92
 
-    // Calculate stereo panning coefficients
-    // Maintains constant power panning: vol_L^2 + vol_R^2 = constant
-    const sF32 pan = 0.5f + 0.5f * MasterSeparation;
-    const sF32 vm0 = MasterVolume * sFSqrt(pan);
-    const sF32 vm1 = MasterVolume * sFSqrt(1 - pan);
+    // Stereo panning coefficients (cached between calls)
+    UpdateGains();
+    const sF32 vm0 = Gain0;
+    const sF32 vm1 = Gain1;
+
+    TRACE_PROBE1(render_start, samples);
+
+    // Large blocks: filter frames in parallel
+    if (Pool && samples >= PAR_MIN)
+    {
+        RenderParallel(outbuf, samples);
+        TRACE_PROBE1(render_end, samples);
+        return;
+    }
+
+    // The FIR is timed as the whole loop minus the voice refills
+    sU64 start = stats_now();
+    sU64 calc = 0;
 
     // Generate output samples
     for (sInt s = 0; s < samples; s++)
@@ -115,48 +371,212 @@ void Paula::Render(sF32 *outbuf, sInt samples)
         if (WritePos < ReadPos)
             ReadEnd -= RBSIZE;
         if (ReadEnd > WritePos)
+        {
+            sU64 c0 = stats_now();
             Calc();  // Generate more Paula samples
+            calc += stats_now() - c0;
+        }
 
-        // FIR filter: convolution with filter coefficients
-        sF32 outl0 = 0, outl1 = 0;         // Left channel (two taps for interpolation)
-        sF32 outr0 = 0, outr1 = 0;         // Right channel
-
-        // Calculate offset into ring buffer
+        // FIR filter straight from the ring buffer, leaving out each side
+        // whose taps from offs up to WritePos are all zero (its filter
+        // output would be exactly 0)
         sInt offs = (ReadPos - FIR_WIDTH - 1) & (RBSIZE - 1);
+        sInt taps = (WritePos - offs - 1) & (RBSIZE - 1);
+        sInt zero = (taps < ZeroRun[0] ? 1 : 0) | (taps < ZeroRun[1] ? 2 : 0);
+        if (zero == 3)
+            outbuf[0] = outbuf[1] = 0;
+        else if (zero)
+        {
+            sF32 outl = (zero & 1) ? 0 : FilterChannel(RingBuf, offs, RBSIZE - 1, FIRMem, ReadFrac);
+            sF32 outr = (zero & 2) ? 0 : FilterChannel(RingBuf + RBSIZE, offs, RBSIZE - 1, FIRMem, ReadFrac);
+            outbuf[0] = vm0 * outl + vm1 * outr;
+            outbuf[1] = vm1 * outl + vm0 * outr;
+        }
+        else
+            FilterFrame(RingBuf, offs, RBSIZE - 1, RBSIZE, FIRMem, ReadFrac, vm0, vm1, outbuf);
+        outbuf += 2;
+
+        // Advance read position with fractional interpolation
+        ReadFrac += step;
+        sInt rfi = sInt(ReadFrac);
+        ReadPos = (ReadPos + rfi) & (RBSIZE - 1);
+        ReadFrac -= rfi;  // Keep only fractional part
+    }
+
+    stats_add(STATS_FIR, start + calc, samples);
+    TRACE_PROBE1(render_end, samples);
+}
+
+// =================== Paula::FilterStream ===================
+// FIR stage only, reading from a stream produced elsewhere
+void Paula::FilterStream(const sF32 *buf, sInt size, sInt &pos, sF32 &frac, sF32 *outbuf, sInt samples)
+{
+    const sF32 step = sF32(PAULARATE) / sF32(OUTRATE);
+
+    UpdateGains();
+    const sF32 vm0 = Gain0;
+    const sF32 vm1 = Gain1;
+    sU64 start = stats_now();
+
+    for (sInt s = 0; s < samples; s++)
+    {
+        FilterFrame(buf, pos, size - 1, size, FIRMem, frac, vm0, vm1, outbuf);
+        outbuf += 2;
+
+        frac += step;
+        sInt rfi = sInt(frac);
+        pos = (pos + rfi) & (size - 1);
+        frac -= rfi;
+    }
+
+    stats_add(STATS_FIR, start, samples);
+}
+
+// =================== Parallel FIR ===================
+// One slice of output frames for a pool worker
+struct FIRTask
+{
+    Paula *P;
+    sF32 *Out;
+    sInt First, Count;
+    sF32 VM0, VM1;
+};
+
+static void fir_task(void *parm, sInt worker)
+{
+    FIRTask *t = (FIRTask *)parm;
+    (void)worker;
+    t->P->FilterStaged(t->Out, t->First, t->Count, t->VM0, t->VM1);
+}
+
+// Copy ring buffer samples [from, to) to the staging buffer at dst
+// Returns number of samples copied
+static sInt stage_ring(const sF32 *ring, sF32 *stage, sInt from, sInt to, sInt dst)
+{
+    sInt count = (to - from) & (Paula::RBSIZE - 1);
+    for (sInt i = 0; i < count; i++)
+    {
+        sInt r = (from + i) & (Paula::RBSIZE - 1);
+        stage[dst + i] = ring[r];
+        stage[dst + i + Paula::STAGE_SIZE] = ring[r + Paula::RBSIZE];
+    }
+    return count;
+}
+
+// =================== Paula::SetThreadPool ===================
+void Paula::SetThreadPool(ThreadPool *pool)
+{
+    Pool = pool;
+    if (Pool && !Stage)
+    {
+        Stage = (sF32 *)malloc(sizeof(sF32) * 2 * STAGE_SIZE);
+        StageOffs = (sInt *)malloc(sizeof(sInt) * PAR_BLOCK);
+        StageFrac = (sF32 *)malloc(sizeof(sF32) * PAR_BLOCK);
+        if (!Stage || !StageOffs || !StageFrac)
+            Pool = 0;  // Out of memory: stay serial
+    }
+}
+
+// =================== Paula::FilterStaged ===================
+void Paula::FilterStaged(sF32 *outbuf, sInt first, sInt count, sF32 vm0, sF32 vm1)
+{
+    for (sInt s = first; s < first + count; s++)
+        FilterFrame(Stage, StageOffs[s], STAGE_SIZE - 1, STAGE_SIZE, FIRMem, StageFrac[s], vm0, vm1,
+                    outbuf + 2 * s);
+}
+
+// =================== Paula::RenderParallel ===================
+// Same stepping and refill points as Render(), but every Paula-rate
+// sample is also appended to a linear staging buffer. Since nothing in
+// the staging buffer is overwritten within a block, all frames of the
+// block can then be filtered at once, each from its own staged offset.
+void Paula::RenderParallel(sF32 *outbuf, sInt samples)
+{
+    const sF32 step = sF32(PAULARATE) / sF32(OUTRATE);
 
-        // Load first sample pair
-        sF32 vl = RingBuf[offs];
-        sF32 vr = RingBuf[offs + RBSIZE];
+    UpdateGains();
+    const sF32 vm0 = Gain0;
+    const sF32 vm1 = Gain1;
 
-        // Convolve with FIR filter coefficients
-        for (sInt i = 1; i < 2 * FIR_WIDTH - 1; i++)
+    while (samples > 0)
+    {
+        sInt n = sMin(samples, PAR_BLOCK);
+
+        // === Serial Stage: Voice Generation ===
+        // Start with the ring contents from the first FIR tap on
+        sInt staged = stage_ring(RingBuf, Stage, (ReadPos - FIR_WIDTH - 1) & (RBSIZE - 1), WritePos, 0);
+        sInt lin = 0;
+
+        for (sInt s = 0; s < n; s++)
         {
-            sF32 w = FIRMem[i];             // FIR coefficient
-            outl0 += vl * w;                // Accumulate left channel tap 0
-            outr0 += vr * w;                // Accumulate right channel tap 0
+            sInt ReadEnd = ReadPos + FIR_WIDTH + 1;
+            if (WritePos < ReadPos)
+                ReadEnd -= RBSIZE;
+            if (ReadEnd > WritePos)
+            {
+                sInt from = WritePos;
+                Calc();
+                staged += stage_ring(RingBuf, Stage, from, WritePos, staged);
+            }
 
-            // Advance to next sample
-            offs = (offs + 1) & (RBSIZE - 1);
-            vl = RingBuf[offs];
-            vr = RingBuf[offs + RBSIZE];
+            StageOffs[s] = lin;
+            StageFrac[s] = ReadFrac;
 
-            outl1 += vl * w;                // Accumulate left channel tap 1
-            outr1 += vr * w;                // Accumulate right channel tap 1
+            ReadFrac += step;
+            sInt rfi = sInt(ReadFrac);
+            ReadPos = (ReadPos + rfi) & (RBSIZE - 1);
+            ReadFrac -= rfi;
+            lin += rfi;
         }
 
-        // Linear interpolation between two filter taps
-        sF32 outl = sLerp(outl0, outl1, ReadFrac);
-        sF32 outr = sLerp(outr0, outr1, ReadFrac);
+        // === Parallel Stage: FIR ===
+        // The calling thread filters the first slice itself
+        // (timed as wall clock time of the whole stage)
+        sU64 start = stats_now();
+        FIRTask tasks[64];
+        sInt parts = sClamp(Pool->GetThreadCount() + 1, 1, 64);
+        sInt slice = (n + parts - 1) / parts;
+        ThreadPool::Group group;
+
+        for (sInt i = 1; i < parts && i * slice < n; i++)
+        {
+            FIRTask &t = tasks[i];
+            t.P = this;
+            t.Out = outbuf;
+            t.First = i * slice;
+            t.Count = sMin(slice, n - t.First);
+            t.VM0 = vm0;
+            t.VM1 = vm1;
+            Pool->Submit(fir_task, &t, &group);
+        }
+        FilterStaged(outbuf, 0, sMin(slice, n), vm0, vm1);
+        Pool->Wait(group);
+        stats_add(STATS_FIR, start, n);
 
-        // Apply panning and output (constant power stereo mixing)
-        *outbuf++ = vm0 * outl + vm1 * outr;  // Output sample (mixed)
-        *outbuf++ = vm1 * outl + vm0 * outr;  // Swapped for stereo separation
+        outbuf += 2 * n;
+        samples -= n;
+    }
+}
+
+// =================== Paula::Advance ===================
+// Step the read position like Render() without filtering
+void Paula::Advance(sInt samples, sBool generate)
+{
+    const sF32 step = sF32(PAULARATE) / sF32(OUTRATE);
+
+    for (sInt s = 0; s < samples; s++)
+    {
+        // Refill the ring buffer at exactly the same points as Render()
+        sInt ReadEnd = ReadPos + FIR_WIDTH + 1;
+        if (WritePos < ReadPos)
+            ReadEnd -= RBSIZE;
+        if (ReadEnd > WritePos)
+            Calc(generate);
 
-        // Advance read position with fractional interpolation
         ReadFrac += step;
         sInt rfi = sInt(ReadFrac);
         ReadPos = (ReadPos + rfi) & (RBSIZE - 1);
-        ReadFrac -= rfi;  // Keep only fractional part
+        ReadFrac -= rfi;
     }
 }
 
@@ -185,8 +605,58 @@ Paula::Paula()
     ReadPos = 0;
     ReadFrac = 0;
     WritePos = FIR_WIDTH;
+    ZeroRun[0] = ZeroRun[1] = RBSIZE;
 
     // Initialize master volume and panning
     MasterVolume = 0.66f;                  // Default to 66% volume
     MasterSeparation = 0.5f;               // Default to 50:50 stereo separation
+    MuteMask = 0;                          // All voices audible
+    GainVolume = -1;                       // Gains computed on first use
+    GainSeparation = -1;
+
+    // No stream hook, serial FIR until a thread pool is attached
+    CalcHook = 0;
+    CalcHookParm = 0;
+    Pool = 0;
+    Stage = 0;
+    StageOffs = 0;
+    StageFrac = 0;
+}
+
+// =================== Paula::Copy Constructor ===================
+// Copies the complete emulation state, but not the stream hook or the
+// parallel FIR setup
+Paula::Paula(const Paula &src)
+{
+    memcpy(FIRMem, src.FIRMem, sizeof(FIRMem));
+    for (sInt i = 0; i < 4; i++)
+        V[i] = src.V[i];
+
+    memcpy(RingBuf, src.RingBuf, sizeof(RingBuf));
+    WritePos = src.WritePos;
+    ReadPos = src.ReadPos;
+    ReadFrac = src.ReadFrac;
+    ZeroRun[0] = src.ZeroRun[0];
+    ZeroRun[1] = src.ZeroRun[1];
+    MuteMask = src.MuteMask;
+
+    MasterVolume = src.MasterVolume;
+    MasterSeparation = src.MasterSeparation;
+    GainVolume = -1;
+    GainSeparation = -1;
+
+    CalcHook = 0;
+    CalcHookParm = 0;
+    Pool = 0;
+    Stage = 0;
+    StageOffs = 0;
+    StageFrac = 0;
+}
+
+// =================== Paula::Destructor ===================
+Paula::~Paula()
+{
+    free(Stage);
+    free(StageOffs);
+    free(StageFrac);
 }
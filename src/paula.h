@@ -9,6 +9,8 @@
 #include "types.h"
 #include "config.h"
 
+class ThreadPool;
+
 // =================== Paula Class ===================
 // Represents the Amiga Paula audio chip emulator
 class Paula
@@ -18,6 +20,17 @@ public:
     static const sInt FIR_WIDTH = 512;     // Finite Impulse Response filter width
     sF32 FIRMem[2 * FIR_WIDTH + 1];       // FIR filter coefficients (1025 taps)
 
+    // === 8-bit DAC ===
+    // Output level of every sample byte, indexed by the raw (two's
+    // complement) byte, so a sample fetch is a single load. The default
+    // is the ideal DAC, byte / 128.
+    static sF32 DacTable[256];
+
+    // Rebuild DacTable for a DAC whose bits have the given weights
+    // (weights[0] = LSB; the ideal DAC is 1, 2, 4, ... 128), to model a
+    // measured nonlinearity. Affects all Paulas; call before rendering.
+    static void SetDacWeights(const sF64 weights[8]);
+
     // =================== Voice Structure ===================
     // Represents a single audio channel (Paula has 4 voices)
     struct Voice
@@ -25,10 +38,17 @@ public:
     private:
         sInt Pos;                          // Current sample position in waveform
         sInt PWMCnt, DivCnt;               // PWM counter and period divider
-        sIntFlt Cur;                       // Current sample value (float/int union)
+        sF32 Cur;                          // Current sample value (DAC output)
+        sBool LoopSilent;                  // Loop is all zero bytes
+        const sS8 *Loop;                   // Repeated loop to switch to at SampleLen (NULL = none)
+        sInt LoopPad;                      // Length of Loop in bytes
+
+        // Handle reaching SampleLen: jump back to the loop start, or move
+        // over to the repeated loop the first time
+        void Wrap();
 
     public:
-        sS8 *Sample;                       // Pointer to sample data
+        const sS8 *Sample;                 // Pointer to sample data
         sInt SampleLen;                    // Total sample length in words
         sInt LoopLen;                      // Loop length in words
         sInt Period;                       // Audio period (sample playback rate)
@@ -36,24 +56,42 @@ public:
 
         // Voice constructor: initialize all values to default/zero
         Voice()
-            : Period(65535), Volume(0), Sample(0), Pos(0), PWMCnt(0), DivCnt(0), LoopLen(1)
+            : Pos(0), PWMCnt(0), DivCnt(0), Cur(0), LoopSilent(0), Loop(0), LoopPad(0), Sample(0),
+              SampleLen(0), LoopLen(1), Period(65535), Volume(0)
         {
-            Cur.F32 = 0;
         }
 
         // Render voice samples into output buffer
-        // Uses PWM (Pulse Width Modulation) to convert sample data
+        // Uses PWM (Pulse Width Modulation) to apply the volume to the DAC
+        // output (a volume-scaled DacTable would be the place to fuse it
+        // into the fetch instead)
+        // Works in spans between sample fetches; with padded samples (see
+        // Module::PaddedSample) the loop wrap is rarely taken
         void Render(sF32 *buffer, sInt samples);
 
+        // Advance voice state by the given number of samples without
+        // producing output (exactly the state Render() would leave)
+        void Skip(sInt samples);
+
+        // True if Render() would only add zeros until the voice is changed:
+        // no sample, volume 0, or playing inside a silent loop (such as the
+        // tail of a finished one-shot sample ending on a zero byte)
+        sBool IsIdle() const;
+
         // Trigger voice: start playing a sample
         // smp: pointer to sample data
         // sl: sample length in words
         // ll: loop length in words
         // offs: offset into sample (default 0)
-        void Trigger(sS8 *smp, sInt sl, sInt ll, sInt offs = 0);
+        // silent: the loop is all zero bytes (lets IsIdle() skip it)
+        // loop: copies of the loop to continue with once the sample end
+        // is reached, padlen bytes long (see Module::PaddedSample)
+        void Trigger(const sS8 *smp, sInt sl, sInt ll, sInt offs = 0, sBool silent = 0, const sS8 *loop = 0,
+                     sInt padlen = 0);
     };
 
     Voice V[4];                            // Array of 4 voices (Paula has 4 audio channels)
+    sInt MuteMask;                         // Muted voices (bit i = V[i]), only advanced like idle ones
 
     // =================== Ring Buffer ===================
     // Circular buffer stores audio samples at Paula rate before resampling
@@ -62,13 +100,28 @@ public:
     sInt WritePos;                         // Current write position in ring buffer
     sInt ReadPos;                          // Current read position in ring buffer
     sF32 ReadFrac;                         // Fractional position for interpolation
+    sInt ZeroRun[2];                       // Per side (left, right): samples up to WritePos known
+                                           // to be zero (RBSIZE = whole ring)
 
     // Generate audio fragments at Paula rate (3.74 MHz)
     // This is where the actual Paula emulation happens
-    void CalcFrag(sF32 *out, sInt samples);
+    // Idle and muted voices are only advanced
+    // Returns the sides whose voices were all idle or muted (bit 0 =
+    // left, bit 1 = right; 3 = out is all zeros)
+    sInt CalcFrag(sF32 *out, sInt samples);
+
+    // Advance all voices by a number of Paula-rate samples without output
+    void SkipFrag(sInt samples);
 
     // Calculate and fill ring buffer with new Paula-rate samples
-    void Calc();
+    // generate: false only advances voice state and ring positions
+    void Calc(sBool generate = 1);
+
+    // Optional hook receiving freshly generated ring buffer samples
+    // (count samples starting at ring index from, already written)
+    typedef void (*CalcHookFunc)(void *parm, const Paula *p, sInt from, sInt count);
+    CalcHookFunc CalcHook;                 // Hook function (NULL = none)
+    void *CalcHookParm;                    // Hook parameter
 
     // =================== Output Rendering ===================
     // Master volume control (0.0 = silent, 1.0 = full volume)
@@ -79,10 +132,72 @@ public:
 
     // Resample from Paula rate to output rate and apply FIR filter
     // Uses windowed-sinc FIR filtering for high-quality resampling
+    // A side whose taps are all zero (such as one with both voices
+    // muted) is left out of the FIR
     void Render(sF32 *outbuf, sInt samples);
 
+    // Advance by a number of output samples without running the FIR
+    // generate: true fills the ring buffer exactly as Render() would
+    //           (used to warm up a restored state), false only tracks
+    //           voice and ring positions (cheap sequencer pre-scan)
+    void Advance(sInt samples, sBool generate);
+
+    // =================== Parallel FIR ===================
+    // Large Render() calls can split the FIR stage across a thread pool
+    // Voices are still generated serially, but the Paula-rate samples of a
+    // whole block are staged linearly so that every output frame can be
+    // filtered independently. The output is bit-identical to the serial path.
+    static const sInt STAGE_SIZE = 1 << 19;    // Staging buffer size per channel (power of 2)
+    static const sInt PAR_BLOCK = 4096;        // Maximum frames staged at once
+    static const sInt PAR_MIN = 512;           // Smaller Render() calls stay serial
+
+    ThreadPool *Pool;                      // Thread pool for the FIR (NULL = serial)
+    sF32 *Stage;                           // Linear Paula-rate staging buffer (left + right)
+    sInt *StageOffs;                       // Per frame: first FIR tap in the staging buffer
+    sF32 *StageFrac;                       // Per frame: interpolation fraction
+
+    // Enable (pool != NULL) or disable the parallel FIR
+    // The pool must outlive this Paula or be detached first
+    void SetThreadPool(ThreadPool *pool);
+
+    // Filter frames whose taps have been staged by RenderParallel()
+    void FilterStaged(sF32 *outbuf, sInt first, sInt count, sF32 vm0, sF32 vm1);
+
+    // Render() variant: serial voice generation, parallel FIR
+    void RenderParallel(sF32 *outbuf, sInt samples);
+
+    // Filter output samples from an external Paula-rate stream
+    // buf: planar stream of size samples per channel (power of 2),
+    //      left at buf[i], right at buf[i + size]
+    // pos/frac: index of the first FIR tap and fraction, advanced like
+    //           Render() advances ReadPos/ReadFrac
+    void FilterStream(const sF32 *buf, sInt size, sInt &pos, sF32 &frac, sF32 *outbuf, sInt samples);
+
     // Paula constructor: initialize FIR filter and ring buffer
     Paula();
+
+    // Copy the emulator state (the copy renders serially)
+    Paula(const Paula &src);
+
+    ~Paula();
+
+private:
+    Paula &operator=(const Paula &);       // Not assignable (owns staging buffers)
+
+    // Stereo gains derived from MasterVolume/MasterSeparation
+    sF32 GainVolume;                       // MasterVolume the gains were computed for
+    sF32 GainSeparation;                   // MasterSeparation the gains were computed for
+    sF32 Gain0;                            // Gain of a channel on its own side
+    sF32 Gain1;                            // Gain of a channel on the opposite side
+
+    // Recompute Gain0/Gain1 if volume or separation changed
+    void UpdateGains();
+
+    // True if voice i only adds zeros (muted or idle)
+    sBool IsQuiet(sInt i) const;
+
+    // Generate count samples into the ring at pos, keeping ZeroRun
+    void CalcRing(sInt pos, sInt count);
 };
 
 #endif // PAULA_H
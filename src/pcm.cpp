@@ -0,0 +1,184 @@
+// =================== PCM Sample Conversion Implementation ===================
+
+#include "pcm.h"
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PCM_SSE2 1
+#endif
+
+// =================== Format Helpers ===================
+sInt format_bytes(sInt format)
+{
+    switch (format)
+    {
+    case FORMAT_S16:
+        return 2;
+    case FORMAT_S24:
+        return 3;
+    default:
+        return 4;
+    }
+}
+
+sInt format_parse(const char *name)
+{
+    if (!strcmp(name, "f32"))
+        return FORMAT_F32;
+    if (!strcmp(name, "s16"))
+        return FORMAT_S16;
+    if (!strcmp(name, "s24"))
+        return FORMAT_S24;
+    if (!strcmp(name, "s32"))
+        return FORMAT_S32;
+    return -1;
+}
+
+// =================== Dither ===================
+void pcm_dither_init(PcmDither &dither, sBool enabled)
+{
+    dither.Enabled = enabled;
+    dither.State[0] = 0x9e3779b9;
+    dither.State[1] = 0x7f4a7c15;
+    dither.State[2] = 0x85ebca6b;
+    dither.State[3] = 0xc2b2ae35;
+}
+
+// One xorshift32 step
+static inline sU32 xorshift(sU32 &x)
+{
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+// Sum of two uniform values in [-0.5, 0.5) LSB: triangular in [-1, 1)
+static inline sF32 tpdf(sU32 &x)
+{
+    sInt a = sInt(xorshift(x));
+    sInt b = sInt(xorshift(x));
+    return (sF32(a) + sF32(b)) * (1.0f / 4294967296.0f);
+}
+
+// =================== Conversion Parameters ===================
+// Scale from float to integer and the clip range (in scaled units)
+// The 32-bit limit is the largest float below 2^31
+static void format_range(sInt format, sF32 &scale, sF32 &lo, sF32 &hi)
+{
+    switch (format)
+    {
+    case FORMAT_S16:
+        scale = 32767.0f;
+        lo = -32768.0f;
+        hi = 32767.0f;
+        break;
+    case FORMAT_S24:
+        scale = 8388607.0f;
+        lo = -8388608.0f;
+        hi = 8388607.0f;
+        break;
+    default:
+        scale = 2147483648.0f;
+        lo = -2147483648.0f;
+        hi = 2147483520.0f;
+        break;
+    }
+}
+
+// Store one converted sample
+static inline sU8 *store(sU8 *p, sInt format, sInt v)
+{
+    p[0] = sU8(v);
+    p[1] = sU8(v >> 8);
+    if (format == FORMAT_S16)
+        return p + 2;
+    p[2] = sU8(v >> 16);
+    if (format == FORMAT_S24)
+        return p + 3;
+    p[3] = sU8(v >> 24);
+    return p + 4;
+}
+
+// =================== pcm_convert ===================
+// Clip to [-1, 1], scale, add dither, clip to the integer range and
+// round to nearest. Without dither this matches lrintf(clamp(v) * scale).
+void pcm_convert(const sF32 *in, void *out, sInt count, sInt format, PcmDither *dither)
+{
+    if (format == FORMAT_F32)
+    {
+        sCopyMem(out, in, sizeof(sF32) * count);
+        return;
+    }
+
+    sF32 scale, lo, hi;
+    format_range(format, scale, lo, hi);
+    sBool dith = dither && dither->Enabled;
+    sU8 *p = (sU8 *)out;
+    sInt i = 0;
+
+#ifdef PCM_SSE2
+    // === Four samples per step ===
+    const __m128 vscale = _mm_set1_ps(scale);
+    const __m128 vone = _mm_set1_ps(1.0f);
+    const __m128 vmone = _mm_set1_ps(-1.0f);
+    const __m128 vlo = _mm_set1_ps(lo);
+    const __m128 vhi = _mm_set1_ps(hi);
+    const __m128 vrnd = _mm_set1_ps(1.0f / 4294967296.0f);
+    __m128i x = dith ? _mm_loadu_si128((const __m128i *)dither->State) : _mm_setzero_si128();
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 v = _mm_loadu_ps(in + i);
+        v = _mm_mul_ps(_mm_min_ps(_mm_max_ps(v, vmone), vone), vscale);
+
+        if (dith)
+        {
+            // Two xorshift steps per lane, summed to a triangular value
+            x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+            x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+            x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+            __m128 a = _mm_cvtepi32_ps(x);
+            x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+            x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+            x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+            __m128 b = _mm_cvtepi32_ps(x);
+            v = _mm_add_ps(v, _mm_mul_ps(_mm_add_ps(a, b), vrnd));
+        }
+
+        __m128i s = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(v, vlo), vhi));
+
+        if (format == FORMAT_S16)
+        {
+            // Values are in range, so saturating packs are exact
+            _mm_storel_epi64((__m128i *)p, _mm_packs_epi32(s, s));
+            p += 8;
+        }
+        else if (format == FORMAT_S32)
+        {
+            _mm_storeu_si128((__m128i *)p, s);
+            p += 16;
+        }
+        else
+        {
+            sInt tmp[4];
+            _mm_storeu_si128((__m128i *)tmp, s);
+            for (sInt j = 0; j < 4; j++)
+                p = store(p, format, tmp[j]);
+        }
+    }
+
+    if (dith)
+        _mm_storeu_si128((__m128i *)dither->State, x);
+#endif
+
+    // === Remaining samples (all of them without SSE2) ===
+    for (; i < count; i++)
+    {
+        sF32 v = sClamp(in[i], -1.0f, 1.0f) * scale;
+        if (dith)
+            v += tpdf(dither->State[i & 3]);
+        p = store(p, format, sInt(lrintf(sClamp(v, lo, hi))));
+    }
+}
@@ -0,0 +1,42 @@
+// =================== PCM Sample Conversion ===================
+// Float to integer PCM conversion with clipping and optional TPDF
+// dither, vectorized with SSE2 where available
+
+#ifndef PCM_H
+#define PCM_H
+
+#include "types.h"
+
+// =================== Sample Formats ===================
+enum SampleFormat
+{
+    FORMAT_F32,                            // 32-bit IEEE float (0dB = 1.0)
+    FORMAT_S16,                            // 16-bit signed integer
+    FORMAT_S24,                            // 24-bit signed integer (packed, 3 bytes)
+    FORMAT_S32,                            // 32-bit signed integer
+};
+
+// Bytes per sample for a given format
+sInt format_bytes(sInt format);
+
+// Parse a format name ("f32", "s16", "s24", "s32"), returns -1 if unknown
+sInt format_parse(const char *name);
+
+// =================== Dither State ===================
+// Triangular (TPDF) dither of +-1 LSB from four xorshift generators
+// The sequence is seeded, so dithered renders are reproducible
+struct PcmDither
+{
+    sBool Enabled;                         // Add dither before rounding
+    sU32 State[4];                         // One generator per SIMD lane
+};
+
+// Initialize dither state (enabled or not) with a fixed seed
+void pcm_dither_init(PcmDither &dither, sBool enabled);
+
+// Convert count float samples to format, clipping to the integer range
+// Little-endian output; for FORMAT_F32 the samples are copied unchanged
+// dither may be NULL (no dither)
+void pcm_convert(const sF32 *in, void *out, sInt count, sInt format, PcmDither *dither);
+
+#endif // PCM_H
@@ -0,0 +1,210 @@
+// =================== Pipelined Renderer Implementation ===================
+// Producer: ModPlayer::Advance with sample generation, Paula's CalcHook
+// copies every generated fragment into the ring
+// Consumer: Paula::FilterStream over the ring, plus the fade-out gain
+// that ModPlayer::Render would have applied
+
+#include "pipeline.h"
+#include <stdlib.h>
+
+// Largest number of Paula-rate samples one output frame advances by
+static const sInt MAX_STEP = sInt(sF32(PAULARATE) / sF32(OUTRATE)) + 1;
+
+// =================== Pipeline Constructor ===================
+Pipeline::Pipeline(ModPlayer *player, Paula *p)
+    : Player(player), P(p), WriteAbs(0), FramesReady(0), FadeStart(-1), Ended(0), Quit(0),
+      ReleaseAbs(0), FramesDone(0), Finished(0), ConsumerWaiting(0), ProducerWaiting(0)
+{
+    Ring = (sF32 *)calloc(2 * RING_SIZE, sizeof(sF32));
+
+    // Seed the ring with the valid part of Paula's ring buffer, starting
+    // at the first FIR tap (a full buffer right after Calc())
+    sInt offs = (P->ReadPos - Paula::FIR_WIDTH - 1) & (Paula::RBSIZE - 1);
+    sInt count = (P->WritePos - offs) & (Paula::RBSIZE - 1);
+    if (!count)
+        count = Paula::RBSIZE;
+
+    for (sInt i = 0; i < count; i++)
+    {
+        sInt src = (offs + i) & (Paula::RBSIZE - 1);
+        Ring[i] = P->RingBuf[src];
+        Ring[i + RING_SIZE] = P->RingBuf[src + Paula::RBSIZE];
+    }
+    WriteAbs = count;
+    ReadAbs = 0;
+    ReadFrac = P->ReadFrac;
+
+    P->CalcHookParm = this;
+    P->CalcHook = CalcHook;
+    Producer = std::thread(&Pipeline::Produce, this);
+}
+
+// =================== Pipeline Destructor ===================
+Pipeline::~Pipeline()
+{
+    Quit = 1;
+    Wake(SpaceFree, ProducerWaiting);
+    Producer.join();
+
+    P->CalcHook = 0;
+    P->CalcHookParm = 0;
+    free(Ring);
+}
+
+// =================== Pipeline::Wake ===================
+// A waiter raises its flag before checking its predicate, and we check
+// the flag after publishing: with a full fence on both sides, either the
+// waiter sees the change or we see the flag. Taking the lock then orders
+// the wakeup after the waiter's predicate check, so it can't be missed.
+void Pipeline::Wake(std::condition_variable &cond, std::atomic<sBool> &waiting)
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!waiting.load(std::memory_order_relaxed))
+        return;
+
+    std::lock_guard<std::mutex> guard(WaitLock);
+    cond.notify_one();
+}
+
+// =================== Pipeline::WaitProducer ===================
+void Pipeline::WaitProducer(sS64 frames, sS64 written)
+{
+    std::unique_lock<std::mutex> lock(WaitLock);
+    ConsumerWaiting.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    DataReady.wait(lock, [&] {
+        return Ended.load(std::memory_order_acquire) || FramesReady.load(std::memory_order_acquire) != frames ||
+               WriteAbs.load(std::memory_order_acquire) != written;
+    });
+    ConsumerWaiting.store(0, std::memory_order_relaxed);
+}
+
+// =================== Pipeline::CalcHook ===================
+// Runs on the producer thread inside Paula::Calc()
+void Pipeline::CalcHook(void *parm, const Paula *p, sInt from, sInt count)
+{
+    Pipeline *pl = (Pipeline *)parm;
+    sS64 wr = pl->WriteAbs.load(std::memory_order_relaxed);
+
+    // Wait until the consumer has released enough of the ring
+    if (wr + count - pl->ReleaseAbs.load(std::memory_order_acquire) > RING_SIZE)
+    {
+        std::unique_lock<std::mutex> lock(pl->WaitLock);
+        pl->ProducerWaiting.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        pl->SpaceFree.wait(lock, [&] {
+            return pl->Quit.load(std::memory_order_relaxed) ||
+                   wr + count - pl->ReleaseAbs.load(std::memory_order_acquire) <= RING_SIZE;
+        });
+        pl->ProducerWaiting.store(0, std::memory_order_relaxed);
+        if (pl->Quit.load(std::memory_order_relaxed))
+            return;
+    }
+
+    for (sInt i = 0; i < count; i++)
+    {
+        sInt dst = sInt(wr + i) & (RING_SIZE - 1);
+        pl->Ring[dst] = p->RingBuf[from + i];
+        pl->Ring[dst + RING_SIZE] = p->RingBuf[from + i + Paula::RBSIZE];
+    }
+    pl->WriteAbs.store(wr + count, std::memory_order_release);
+    pl->Wake(pl->DataReady, pl->ConsumerWaiting);
+}
+
+// =================== Pipeline::Produce ===================
+void Pipeline::Produce()
+{
+    sS64 frames = 0;
+    while (!Quit.load(std::memory_order_relaxed))
+    {
+        frames += Player->Advance(PRODUCE_BLOCK, 1);
+
+        // Publish the fade start before the frames it applies to
+        sInt fade = Player->GetFadePos();
+        if (fade >= 0 && FadeStart.load(std::memory_order_relaxed) < 0)
+            FadeStart.store(frames - fade, std::memory_order_relaxed);
+        FramesReady.store(frames, std::memory_order_release);
+
+        sBool finished = Player->IsFinished();
+        if (finished)
+            Ended.store(1, std::memory_order_release);
+        Wake(DataReady, ConsumerWaiting);
+        if (finished)
+            break;
+    }
+}
+
+// =================== Pipeline::Render ===================
+sU32 Pipeline::Render(sF32 *buf, sU32 len)
+{
+    sU32 done = 0;
+    while (done < len && !Finished)
+    {
+        // Check Ended first: once set, FramesReady is final
+        sBool ended = Ended.load(std::memory_order_acquire);
+        sS64 ready = FramesReady.load(std::memory_order_acquire) - FramesDone;
+        sS64 written = WriteAbs.load(std::memory_order_acquire);
+        if (!ready)
+        {
+            if (ended)
+                Finished = 1;
+            else
+                WaitProducer(FramesDone, written);
+            continue;
+        }
+
+        // Frames whose FIR taps are all in the ring already (the producer
+        // generated everything the remaining frames need once it ended)
+        sS64 n = ready;
+        if (!ended)
+        {
+            sS64 avail = written - ReadAbs;
+            n = sMin<sS64>(n, (avail - 2 * Paula::FIR_WIDTH - 1) / MAX_STEP);
+        }
+        n = sMin<sS64>(n, len - done);
+        if (n <= 0)
+        {
+            WaitProducer(FramesDone + ready, written);
+            continue;
+        }
+
+        // FIR stage
+        sF32 *out = buf + 2 * done;
+        sInt pos = sInt(ReadAbs & (RING_SIZE - 1));
+        sInt start = pos;
+        P->FilterStream(Ring, RING_SIZE, pos, ReadFrac, out, sInt(n));
+        ReadAbs += (pos - start) & (RING_SIZE - 1);
+        ReleaseAbs.store(ReadAbs, std::memory_order_release);
+        Wake(SpaceFree, ProducerWaiting);
+
+        // Fade-out tail, same gain as ModPlayer::Render
+        sS64 fadestart = FadeStart.load(std::memory_order_relaxed);
+        if (fadestart >= 0)
+        {
+            sInt fadelen = Player->GetFadeLen();
+            for (sInt i = 0; i < n; i++)
+            {
+                sS64 fpos = FramesDone + i - fadestart;
+                if (fpos < 0)
+                    continue;
+                sF32 gain = 1.0f - sF32(fpos) / sF32(fadelen);
+                out[2 * i + 0] *= gain;
+                out[2 * i + 1] *= gain;
+            }
+        }
+
+        FramesDone += n;
+        done += sU32(n);
+    }
+
+    // Silence after the end of the song
+    if (done < len)
+        sZeroMem(buf + 2 * done, sizeof(sF32) * 2 * (len - done));
+    return done;
+}
+
+// =================== Pipeline::IsFinished ===================
+sBool Pipeline::IsFinished() const
+{
+    return Finished;
+}
@@ -0,0 +1,85 @@
+// =================== Pipelined Renderer ===================
+// Splits one stream across two threads: a producer thread runs the
+// sequencer and the Paula voice generation, the calling thread only runs
+// the FIR. The Paula-rate signal travels through a lock-free single
+// producer/single consumer ring that also keeps the FIR history; a side
+// that has to wait for the other one blocks instead of spinning.
+// The output is identical to ModPlayer::Render on the same player.
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "types.h"
+#include "paula.h"
+#include "modplayer.h"
+
+// =================== Pipeline Class ===================
+class Pipeline
+{
+private:
+    static const sInt RING_SIZE = 1 << 18;     // Paula-rate samples per channel (~70ms)
+    static const sInt PRODUCE_BLOCK = 256;     // Frames per producer step
+
+    ModPlayer *Player;                     // Sequencer (producer thread only)
+    Paula *P;                              // Paula emulation (voices: producer, FIR: consumer)
+    sF32 *Ring;                            // Planar Paula-rate ring (right at Ring[RING_SIZE])
+
+    // Producer side
+    std::atomic<sS64> WriteAbs;            // Ring samples written (absolute index)
+    std::atomic<sS64> FramesReady;         // Output frames the producer has advanced
+    std::atomic<sS64> FadeStart;           // First frame of the fade-out tail (-1 = none yet)
+    std::atomic<sBool> Ended;              // Song has ended, FramesReady is final
+    std::atomic<sBool> Quit;               // Stop the producer
+
+    // Consumer side
+    std::atomic<sS64> ReleaseAbs;          // Ring samples the consumer no longer needs
+    sS64 ReadAbs;                          // First FIR tap of the next frame (absolute)
+    sF32 ReadFrac;                         // Fractional read position
+    sS64 FramesDone;                       // Output frames filtered so far
+    sBool Finished;                        // All frames delivered
+
+    std::thread Producer;                  // Producer thread
+
+    // Blocking waits (the ring positions themselves stay lock-free; the
+    // lock is only taken when the other side is actually parked)
+    std::mutex WaitLock;
+    std::condition_variable DataReady;     // Producer advanced: WriteAbs, FramesReady or Ended
+    std::condition_variable SpaceFree;     // Consumer released ring space, or Quit
+    std::atomic<sBool> ConsumerWaiting;    // Consumer is parked on DataReady
+    std::atomic<sBool> ProducerWaiting;    // Producer is parked on SpaceFree
+
+    // Wake the thread parked on cond, if waiting says there is one
+    // (after publishing the change)
+    void Wake(std::condition_variable &cond, std::atomic<sBool> &waiting);
+
+    // Consumer: block until the producer moves past the given state
+    // (frames ready and ring samples written) or the song ends
+    void WaitProducer(sS64 frames, sS64 written);
+
+    // Paula::CalcHook: copy freshly generated samples into the ring
+    static void CalcHook(void *parm, const Paula *p, sInt from, sInt count);
+
+    // Producer thread main loop
+    void Produce();
+
+public:
+    // Starts the producer thread; player and p must stay untouched by
+    // other threads until the pipeline is destroyed
+    Pipeline(ModPlayer *player, Paula *p);
+
+    // Stops the producer thread
+    ~Pipeline();
+
+    // Render output frames, same contract as ModPlayer::Render
+    // Returns the number of frames produced before the song ended
+    sU32 Render(sF32 *buf, sU32 len);
+
+    // Returns true once all frames of the song have been delivered
+    sBool IsFinished() const;
+};
+
+#endif // PIPELINE_H
@@ -0,0 +1,502 @@
+// =================== Playlist Playback Implementation ===================
+
+#include "playlist.h"
+#include "paula.h"
+#include "modplayer.h"
+#include "pipeline.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+
+// =================== Playlist ===================
+
+static void path_add(Playlist &list, const char *path)
+{
+    if (list.Count == list.Alloc)
+    {
+        list.Alloc = sMax(16, list.Alloc * 2);
+        list.Paths = (char **)realloc(list.Paths, list.Alloc * sizeof(char *));
+    }
+    list.Paths[list.Count++] = strdup(path);
+}
+
+// Playlist files are named "*.m3u" or "*.m3u8"
+static sBool is_m3u_name(const char *name)
+{
+    size_t len = strlen(name);
+    return (len > 4 && !strcasecmp(name + len - 4, ".m3u")) ||
+           (len > 5 && !strcasecmp(name + len - 5, ".m3u8"));
+}
+
+// =================== playlist_init ===================
+void playlist_init(Playlist &list)
+{
+    list.Paths = NULL;
+    list.Count = 0;
+    list.Alloc = 0;
+}
+
+// =================== playlist_add ===================
+sBool playlist_add(Playlist &list, const char *arg)
+{
+    if (!is_m3u_name(arg))
+    {
+        path_add(list, arg);
+        return 1;
+    }
+
+    FILE *fh = fopen(arg, "r");
+    if (!fh)
+    {
+        perror(arg);
+        return 0;
+    }
+
+    // Relative entries are relative to the playlist file
+    const char *slash = strrchr(arg, '/');
+    sInt dirlen = slash ? sInt(slash - arg + 1) : 0;
+
+    // One path per line, skipping blank lines and '#' comments/directives
+    char line[4096];
+    while (fgets(line, sizeof(line), fh))
+    {
+        size_t len = strlen(line);
+        while (len && isspace((unsigned char)line[len - 1]))
+            line[--len] = 0;
+        if (!len || line[0] == '#')
+            continue;
+
+        if (line[0] == '/' || !dirlen)
+            path_add(list, line);
+        else
+        {
+            char path[8192];
+            snprintf(path, sizeof(path), "%.*s%s", dirlen, arg, line);
+            path_add(list, path);
+        }
+    }
+
+    fclose(fh);
+    return 1;
+}
+
+// =================== playlist_free ===================
+void playlist_free(Playlist &list)
+{
+    for (sInt i = 0; i < list.Count; i++)
+        free(list.Paths[i]);
+    free(list.Paths);
+    playlist_init(list);
+}
+
+// =================== PlaylistPlayer Constructor ===================
+PlaylistPlayer::PlaylistPlayer(const Playlist &list, const RenderOptions &opt, sInt loops, size_t cachebytes)
+    : List(list), Opt(opt), Loops(loops), Cache(cachebytes), Cur(NULL), Current(-1),
+      StreamPos(0), TrackFirst(0), TrackOrigin(0), PendingSeek(0), MixChanged(0), Next(NULL),
+      Retired(NULL), LoadIndex(0), Loading(0), Quit(0)
+{
+    Info = (TrackInfo *)calloc(sMax(list.Count, 1), sizeof(TrackInfo));
+
+    // Paula's own defaults
+    Paula p;
+    Volume = p.MasterVolume;
+    Separation = p.MasterSeparation;
+    Mute = opt.Mute;
+}
+
+// =================== PlaylistPlayer Destructor ===================
+PlaylistPlayer::~PlaylistPlayer()
+{
+    if (Loader.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> guard(Lock);
+            Quit = 1;
+        }
+        Changed.notify_all();
+        Loader.join();
+    }
+
+    FreeTrack(Cur);
+    FreeTrack(Next);
+    FreeTrack(Retired);
+    free(Info);
+}
+
+// =================== PlaylistPlayer::LoadTrack ===================
+// Runs on the loader thread (or in Start), never on the render thread
+PlaylistPlayer::Track *PlaylistPlayer::LoadTrack(sInt index)
+{
+    TrackInfo &info = Info[index];
+    const Module *mod = Cache.Load(List.Paths[index]);
+    if (!mod)
+    {
+        fprintf(stderr, "Skipping %s\n", List.Paths[index]);
+        info.Failed = 1;
+        return NULL;
+    }
+    memcpy(info.Name, mod->Name, sizeof(info.Name));
+    info.Size = mod->GetSize();
+    info.Padding = mod->GetPaddingBytes();
+
+    Track *t = new Track;
+    t->Index = index;
+    t->Mod = mod;
+    t->P = new Paula;
+    t->Player = new ModPlayer(t->P, mod);
+    t->Player->SetLoops(Loops);
+    t->Player->SetFadeOut(sInt(Opt.FadeSeconds * OUTRATE));
+    ApplyMix(t);
+    t->Pipe = Opt.Pipelined ? new Pipeline(t->Player, t->P) : NULL;
+    t->PrerollPos = 0;
+    t->Ended = 0;
+    t->Frames = 0;
+
+    // Pre-scan player for restarts, with its first snapshot at frame 0
+    t->ScanP = new Paula;
+    t->Scan = new ModPlayer(t->ScanP, mod);
+    t->Scan->SetLoops(Loops);
+    t->Scan->SetFadeOut(sInt(Opt.FadeSeconds * OUTRATE));
+    t->ScanFrames = 0;
+    t->ScanEnded = 0;
+    t->Snaps = NULL;
+    t->SnapCount = 0;
+    t->SnapAlloc = 0;
+    ScanTo(t, 0);
+
+    // Render the first frames now: this is where Paula fills its ring
+    // buffer and the FIR history, so the render thread finds the track warm
+    sU64 limit = sU64(Opt.MaxSeconds * OUTRATE);
+    sInt want = sInt(sMin<sU64>(PLAYLIST_PREROLL, limit));
+    t->Preroll = (sF32 *)malloc(sizeof(sF32) * 2 * sMax(want, 1));
+    t->PrerollFrames = want ? sInt(t->Pipe ? t->Pipe->Render(t->Preroll, want)
+                                           : t->Player->Render(t->Preroll, want)) : 0;
+    t->SongEnded = t->PrerollFrames < want;
+    return t;
+}
+
+// =================== PlaylistPlayer::FreeTrack ===================
+void PlaylistPlayer::FreeTrack(Track *t)
+{
+    if (!t)
+        return;
+    delete t->Pipe;                        // Stops the producer before the player goes
+    delete t->Player;
+    delete t->P;
+    for (sInt i = 0; i < t->SnapCount; i++)
+    {
+        delete t->Snaps[i].Player;
+        delete t->Snaps[i].P;
+    }
+    free(t->Snaps);
+    delete t->Scan;
+    delete t->ScanP;
+    t->Mod->Release();
+    free(t->Preroll);
+    delete t;
+}
+
+// =================== PlaylistPlayer::ApplyMix ===================
+void PlaylistPlayer::ApplyMix(Track *t)
+{
+    t->MixVolume = Volume.load(std::memory_order_relaxed);
+    t->MixSeparation = Separation.load(std::memory_order_relaxed);
+    t->P->MasterVolume = t->MixVolume;
+    t->P->MasterSeparation = t->MixSeparation;
+    t->MixMute = Mute.load(std::memory_order_relaxed);
+    t->Player->SetMute(t->MixMute);
+}
+
+// =================== PlaylistPlayer::ScanTo ===================
+// The pre-scan only runs the sequencer and voice positions, so keeping it
+// up with playback costs a fraction of a percent of the render time
+void PlaylistPlayer::ScanTo(Track *t, sU64 frame)
+{
+    for (;;)
+    {
+        // Snapshot the pre-scan at every multiple of PLAYLIST_SNAPSHOT
+        if (t->ScanFrames == sU64(t->SnapCount) * PLAYLIST_SNAPSHOT)
+        {
+            if (t->SnapCount == t->SnapAlloc)
+            {
+                t->SnapAlloc = sMax(16, t->SnapAlloc * 2);
+                t->Snaps = (Snapshot *)realloc(t->Snaps, t->SnapAlloc * sizeof(Snapshot));
+            }
+            Snapshot &s = t->Snaps[t->SnapCount++];
+            s.P = new Paula(*t->ScanP);
+            s.Player = new ModPlayer(*t->Scan, s.P);
+        }
+
+        if (t->ScanEnded || t->ScanFrames >= frame)
+            break;
+
+        sU64 next = sU64(t->SnapCount) * PLAYLIST_SNAPSHOT;
+        sU32 n = sU32(sMin(frame, next) - t->ScanFrames);
+        sU32 got = t->Scan->Advance(n, 0);
+        t->ScanFrames += got;
+        t->ScanEnded = got < n;
+    }
+}
+
+// =================== PlaylistPlayer::RestartTrack ===================
+// Same technique as the parallel renderer: the sequencer pre-scan gives
+// the exact player state, the warm-up refills Paula's ring buffer, and
+// rendering continues sample-exactly from there. The pre-scan starts at
+// the nearest snapshot, so it never covers more than PLAYLIST_SNAPSHOT
+// frames, however long the track has played.
+void PlaylistPlayer::RestartTrack(Track *t, sU64 frame)
+{
+    delete t->Pipe;
+    delete t->Player;
+    delete t->P;
+
+    sU64 limit = sU64(Opt.MaxSeconds * OUTRATE);
+    frame = sMin(frame, limit);
+    sU64 snap = frame > PARALLEL_WARMUP ? frame - PARALLEL_WARMUP : 0;
+    sU32 warmup = sU32(frame - snap);
+
+    // Latest snapshot before the warm-up (seeking forward scans ahead)
+    ScanTo(t, snap);
+    sInt i = sInt(sMin<sU64>(snap / PLAYLIST_SNAPSHOT, t->SnapCount - 1));
+    t->P = new Paula(*t->Snaps[i].P);
+    t->Player = new ModPlayer(*t->Snaps[i].Player, t->P);
+    ApplyMix(t);
+
+    sU32 scan = sU32(snap - sU64(i) * PLAYLIST_SNAPSHOT);
+    sBool ended = t->Player->Advance(scan, 0) < scan;
+    if (!ended)
+        ended = t->Player->Advance(warmup, 1) < warmup;
+
+    t->Pipe = Opt.Pipelined ? new Pipeline(t->Player, t->P) : NULL;
+    t->PrerollFrames = 0;
+    t->PrerollPos = 0;
+    t->SongEnded = ended;
+    t->Frames = frame;
+    t->Ended = ended || frame >= limit;
+}
+
+// =================== PlaylistPlayer::LoadLoop ===================
+void PlaylistPlayer::LoadLoop()
+{
+    std::unique_lock<std::mutex> lock(Lock);
+    for (;;)
+    {
+        Changed.wait(lock, [this] { return Quit || Retired || (!Next && LoadIndex < List.Count); });
+        if (Quit)
+            break;
+
+        // Free finished tracks here rather than on the render thread
+        if (Retired)
+        {
+            Track *t = Retired;
+            Retired = NULL;
+            lock.unlock();
+            FreeTrack(t);
+            lock.lock();
+            continue;
+        }
+
+        // Preload the next entry
+        sInt index = LoadIndex++;
+        Loading = 1;
+        lock.unlock();
+        Track *t = LoadTrack(index);
+        lock.lock();
+        Next = t;
+        Loading = 0;
+        Changed.notify_all();
+    }
+}
+
+// =================== PlaylistPlayer::Start ===================
+sBool PlaylistPlayer::Start()
+{
+    while (!Cur && LoadIndex < List.Count)
+        Cur = LoadTrack(LoadIndex++);
+    if (!Cur)
+        return 0;
+
+    Current.store(Cur->Index, std::memory_order_release);
+    StreamPos = TrackFirst = 0;
+    TrackOrigin = 0;
+    Loader = std::thread(&PlaylistPlayer::LoadLoop, this);
+    return 1;
+}
+
+// =================== PlaylistPlayer::RenderTrack ===================
+sU32 PlaylistPlayer::RenderTrack(Track *t, sF32 *buf, sU32 frames)
+{
+    sU64 limit = sU64(Opt.MaxSeconds * OUTRATE);
+    sU32 todo = sU32(sMin<sU64>(frames, limit - sMin(t->Frames, limit)));
+    sU32 done = 0;
+
+    // Frames rendered ahead by the loader
+    if (t->PrerollPos < t->PrerollFrames)
+    {
+        done = sMin<sU32>(todo, t->PrerollFrames - t->PrerollPos);
+        sCopyMem(buf, t->Preroll + 2 * t->PrerollPos, sizeof(sF32) * 2 * done);
+        t->PrerollPos += done;
+    }
+
+    // Then straight from the player
+    sBool ended = t->PrerollPos == t->PrerollFrames && t->SongEnded;
+    if (done < todo && !ended)
+    {
+        sU32 n = todo - done;
+        sU32 got = t->Pipe ? t->Pipe->Render(buf + 2 * done, n) : t->Player->Render(buf + 2 * done, n);
+        done += got;
+        ended = got < n;
+    }
+
+    t->Frames += done;
+    t->Ended = ended || t->Frames >= limit;
+    ScanTo(t, t->Frames);
+    return done;
+}
+
+// =================== PlaylistPlayer::NextTrack ===================
+void PlaylistPlayer::NextTrack()
+{
+    std::unique_lock<std::mutex> lock(Lock);
+
+    // Normally the loader finished long ago; only wait if it is still busy
+    Changed.wait(lock, [this] { return Next || (!Loading && LoadIndex >= List.Count); });
+
+    Retired = Cur;
+    Cur = Next;
+    Next = NULL;
+    lock.unlock();
+    Changed.notify_all();
+
+    if (Cur)
+    {
+        // Prerolled with an outdated mix: start over (at frame 0 this is cheap)
+        if (Cur->MixVolume != Volume.load(std::memory_order_relaxed) ||
+            Cur->MixSeparation != Separation.load(std::memory_order_relaxed) ||
+            Cur->MixMute != Mute.load(std::memory_order_relaxed))
+            RestartTrack(Cur, 0);
+        TrackFirst = StreamPos;
+        TrackOrigin = sS64(StreamPos);
+    }
+    Current.store(Cur ? Cur->Index : -1, std::memory_order_release);
+}
+
+// =================== PlaylistPlayer::Render ===================
+sU32 PlaylistPlayer::Render(sF32 *buf, sU32 frames)
+{
+    // Apply requested changes at the current position
+    if (Cur && PendingSeek.load(std::memory_order_relaxed))
+        Rewind(StreamPos);
+    else if (Cur && MixChanged.exchange(0))
+    {
+        // A pipeline's producer thread reads the mute mask: restart instead
+        if (Cur->Pipe && Cur->MixMute != Mute.load(std::memory_order_relaxed))
+            Rewind(StreamPos);
+        else
+            ApplyMix(Cur);
+    }
+
+    sU32 done = 0;
+    while (Cur && done < frames)
+    {
+        sU32 n = RenderTrack(Cur, buf + 2 * done, frames - done);
+        done += n;
+        StreamPos += n;
+        if (Cur->Ended)
+            NextTrack();
+    }
+
+    // After the last track: zero-fill like ModPlayer::Render
+    if (done < frames)
+        sZeroMem(buf + 2 * done, sizeof(sF32) * 2 * (frames - done));
+    return done;
+}
+
+// =================== PlaylistPlayer::Rewind ===================
+sU64 PlaylistPlayer::Rewind(sU64 frame)
+{
+    if (!Cur)
+        return StreamPos;                  // Ended, nothing left to redo
+
+    frame = sClamp(frame, TrackFirst, StreamPos);
+    sS64 pos = sS64(frame) - TrackOrigin + PendingSeek.exchange(0);
+    sU64 trackframe = sU64(sMax<sS64>(pos, 0));
+    MixChanged = 0;
+
+    RestartTrack(Cur, trackframe);
+    TrackOrigin = sS64(frame) - sS64(Cur->Frames);
+    StreamPos = frame;
+    return frame;
+}
+
+// =================== PlaylistPlayer::Seek ===================
+void PlaylistPlayer::Seek(sF32 seconds)
+{
+    PendingSeek.fetch_add(sS64(seconds * OUTRATE));
+}
+
+// =================== PlaylistPlayer::SetMix ===================
+void PlaylistPlayer::SetMix(sF32 volume, sF32 separation)
+{
+    Volume = volume;
+    Separation = separation;
+    MixChanged = 1;
+}
+
+// =================== PlaylistPlayer::GetMix ===================
+void PlaylistPlayer::GetMix(sF32 &volume, sF32 &separation) const
+{
+    volume = Volume;
+    separation = Separation;
+}
+
+// =================== PlaylistPlayer::SetMute ===================
+void PlaylistPlayer::SetMute(sInt mask)
+{
+    Mute = mask;
+    MixChanged = 1;
+}
+
+// =================== PlaylistPlayer::GetMute ===================
+sInt PlaylistPlayer::GetMute() const
+{
+    return Mute;
+}
+
+// =================== PlaylistPlayer::IsFinished ===================
+sBool PlaylistPlayer::IsFinished() const
+{
+    return Current.load(std::memory_order_acquire) < 0;
+}
+
+// =================== PlaylistPlayer::GetCurrent ===================
+sInt PlaylistPlayer::GetCurrent() const
+{
+    return Current.load(std::memory_order_acquire);
+}
+
+// =================== PlaylistPlayer::GetCount ===================
+sInt PlaylistPlayer::GetCount() const
+{
+    return List.Count;
+}
+
+// =================== PlaylistPlayer::GetInfo ===================
+const TrackInfo &PlaylistPlayer::GetInfo(sInt index) const
+{
+    return Info[index];
+}
+
+// =================== PlaylistPlayer::RenderProxy ===================
+sU32 PlaylistPlayer::RenderProxy(void *parm, sF32 *buf, sU32 frames)
+{
+    return ((PlaylistPlayer *)parm)->Render(buf, frames);
+}
+
+// =================== PlaylistPlayer::RewindProxy ===================
+sU64 PlaylistPlayer::RewindProxy(void *parm, sU64 frame)
+{
+    return ((PlaylistPlayer *)parm)->Rewind(frame);
+}
@@ -0,0 +1,200 @@
+// =================== Playlist Playback ===================
+// Plays a list of modules back to back as one continuous stream
+// While a track plays, a loader thread loads and parses the next one and
+// renders its first frames (warming up Paula's ring buffer and FIR
+// history). The switch happens inside a render call, sample-accurate and
+// without reopening the audio stream; each track's output is identical
+// to playing it on its own.
+// Seeking and volume/separation/mute changes restart the current track at
+// the exact frame (from the nearest snapshot of a sequencer pre-scan that
+// keeps up with playback, plus a short warm-up), so a render-ahead buffer
+// can rewind the stream and render it again. A restart costs the same at
+// any point of the track, well below RENDER_AHEAD_GUARD.
+
+#ifndef PLAYLIST_H
+#define PLAYLIST_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "types.h"
+#include "config.h"
+#include "render.h"
+#include "modcache.h"
+
+class Paula;
+class ModPlayer;
+class Pipeline;
+
+// =================== Playlist ===================
+// Growable array of heap allocated track paths
+struct Playlist
+{
+    char **Paths;
+    sInt Count;
+    sInt Alloc;
+};
+
+// Start an empty playlist
+void playlist_init(Playlist &list);
+
+// Add a module, or every entry of an .m3u/.m3u8 file (relative entries
+// are resolved against the playlist's directory)
+// Returns false if a playlist file cannot be read
+sBool playlist_add(Playlist &list, const char *arg);
+
+// Free all paths
+void playlist_free(Playlist &list);
+
+// =================== Track Information ===================
+struct TrackInfo
+{
+    char Name[21];                         // Song name (empty until loaded)
+    size_t Size;                           // File size in bytes
+    size_t Padding;                        // Repeated sample loop memory in bytes
+    sBool Failed;                          // Could not be loaded (skipped)
+};
+
+// =================== PlaylistPlayer Class ===================
+class PlaylistPlayer
+{
+private:
+    // Player state at one point of a track (see Track::Snaps)
+    struct Snapshot
+    {
+        Paula *P;                          // Paula emulator state
+        ModPlayer *Player;                 // Playback state
+    };
+
+    // One loaded track: module, emulator and player
+    struct Track
+    {
+        sInt Index;                        // Position in the playlist
+        const Module *Mod;                 // Shared module (one reference held)
+        Paula *P;                          // Paula emulator
+        ModPlayer *Player;                 // Playback state
+        Pipeline *Pipe;                    // Producer thread (NULL = render directly)
+        sF32 *Preroll;                     // First frames, rendered by the loader
+        sInt PrerollFrames;                // Frames in Preroll
+        sInt PrerollPos;                   // Preroll frames already played
+        sBool SongEnded;                   // Song ended while rendering the preroll
+        sBool Ended;                       // No more frames in this track
+        sU64 Frames;                       // Track position in frames
+        sF32 MixVolume;                    // Paula volume the track renders with
+        sF32 MixSeparation;                // Paula separation the track renders with
+        sInt MixMute;                      // Muted channels the track renders with
+
+        // Restart points (render thread only)
+        Paula *ScanP;                      // Pre-scan Paula (voice positions only)
+        ModPlayer *Scan;                   // Pre-scan player, kept up with Frames
+        sU64 ScanFrames;                   // Frames the pre-scan has advanced
+        sBool ScanEnded;                   // Song ended during the pre-scan
+        Snapshot *Snaps;                   // Snaps[i]: pre-scan at frame i * PLAYLIST_SNAPSHOT
+        sInt SnapCount;                    // Snapshots taken
+        sInt SnapAlloc;                    // Capacity of Snaps
+    };
+
+    const Playlist &List;                  // Tracks to play
+    RenderOptions Opt;                     // Per-track fade, time limit and pipelining
+    sInt Loops;                            // Passes through each song
+    ModuleCache Cache;                     // Repeated tracks are parsed once
+    TrackInfo *Info;                       // Per track, filled in by the loader
+
+    Track *Cur;                            // Track being rendered (render thread)
+    std::atomic<sInt> Current;             // Index of Cur (-1 = finished)
+    sU64 StreamPos;                        // Stream frames rendered (render thread)
+    sU64 TrackFirst;                       // Stream frame Cur started at
+    sS64 TrackOrigin;                      // Stream frame of Cur's track frame 0 (moves with seeks)
+
+    // Requested changes, applied by the render thread
+    std::atomic<sS64> PendingSeek;         // Frames to seek by (0 = none)
+    std::atomic<sF32> Volume;              // Paula master volume
+    std::atomic<sF32> Separation;          // Paula stereo separation
+    std::atomic<sInt> Mute;                // Muted channels (ModPlayer::SetMute)
+    std::atomic<sBool> MixChanged;         // Volume, separation or mute changed
+
+    // Loader thread, guarded by Lock
+    std::thread Loader;                    // Loads the next track and frees old ones
+    std::mutex Lock;
+    std::condition_variable Changed;       // Signals Next/Retired/LoadIndex changes
+    Track *Next;                           // Preloaded track (NULL = none yet)
+    Track *Retired;                        // Finished track waiting to be freed
+    sInt LoadIndex;                        // Next playlist entry to load
+    sBool Loading;                         // Loader is working on an entry
+    sBool Quit;                            // Stop the loader
+
+    // Load, set up and preroll one track (NULL if it cannot be loaded)
+    Track *LoadTrack(sInt index);
+
+    // Stop and free a track
+    static void FreeTrack(Track *t);
+
+    // Set a track's Paula to the requested volume and separation
+    void ApplyMix(Track *t);
+
+    // Advance a track's pre-scan to the given frame, taking a snapshot at
+    // every multiple of PLAYLIST_SNAPSHOT on the way
+    static void ScanTo(Track *t, sU64 frame);
+
+    // Start a track again at the given track frame with the current mix
+    void RestartTrack(Track *t, sU64 frame);
+
+    // Render from one track, up to its time limit
+    sU32 RenderTrack(Track *t, sF32 *buf, sU32 frames);
+
+    // Switch to the preloaded track, waiting for the loader if needed
+    void NextTrack();
+
+    // Loader thread main loop
+    void LoadLoop();
+
+public:
+    // loops: passes through each song (0 = until opt.MaxSeconds)
+    // cachebytes: parsed module cache budget (0 = no caching)
+    PlaylistPlayer(const Playlist &list, const RenderOptions &opt, sInt loops, size_t cachebytes);
+    ~PlaylistPlayer();
+
+    // Load the first playable track and start the loader thread
+    // Returns false if no track could be loaded
+    sBool Start();
+
+    // Render the stream; tracks follow each other without a gap
+    // Returns fewer frames than requested only after the last track
+    sU32 Render(sF32 *buf, sU32 frames);
+
+    // Restart rendering at a stream frame, applying a pending seek and
+    // the current mix (StreamRewindFunc contract; render thread only)
+    // Frames before the current track are not rendered again
+    sU64 Rewind(sU64 frame);
+
+    // Seek within the current track (from any thread; takes effect with
+    // the next render call or rewind)
+    void Seek(sF32 seconds);
+
+    // Change Paula volume and stereo separation (from any thread)
+    void SetMix(sF32 volume, sF32 separation);
+    void GetMix(sF32 &volume, sF32 &separation) const;
+
+    // Change the muted channels (from any thread; see ModPlayer::SetMute)
+    void SetMute(sInt mask);
+    sInt GetMute() const;
+
+    // Returns true once the last track has ended
+    sBool IsFinished() const;
+
+    // Index of the track being rendered (-1 once finished)
+    sInt GetCurrent() const;
+
+    // Number of tracks in the playlist
+    sInt GetCount() const;
+
+    // Information on a track (valid once it became current)
+    const TrackInfo &GetInfo(sInt index) const;
+
+    // StreamRenderFunc/StreamRewindFunc adapters
+    static sU32 RenderProxy(void *parm, sF32 *buf, sU32 frames);
+    static sU64 RewindProxy(void *parm, sU64 frame);
+};
+
+#endif // PLAYLIST_H
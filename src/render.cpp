@@ -0,0 +1,275 @@
+// =================== Offline Renderer Implementation ===================
+// Drives ModPlayer/Paula without any audio device
+
+#include "render.h"
+#include "paula.h"
+#include "modplayer.h"
+#include "wavwriter.h"
+#include "threadpool.h"
+#include "pipeline.h"
+#include "pcm.h"
+#include <stdlib.h>
+
+// =================== render_defaults ===================
+void render_defaults(RenderOptions &opt)
+{
+    opt.Format = FORMAT_F32;
+    opt.Raw = 0;
+    opt.Loops = 1;
+    opt.FadeSeconds = 0;
+    opt.MaxSeconds = NUM_SECONDS;
+    opt.BlockSize = RENDER_BLOCK_SIZE;
+    opt.Threads = 1;
+    opt.FIRThreads = 1;
+    opt.Pipelined = 0;
+    opt.Dither = 0;
+    opt.Mute = 0;
+}
+
+// =================== Parallel Rendering ===================
+// The sequencer and the voice positions do not depend on the FIR output,
+// so a cheap pre-scan (ModPlayer::Advance without generating samples)
+// yields the exact player state at any point of the song. Each chunk
+// starts from such a snapshot taken PARALLEL_WARMUP frames early; the
+// warm-up regenerates the Paula-rate ring buffer contents the FIR needs,
+// after which the chunk renders sample-exactly like the serial path.
+
+struct RenderChunk
+{
+    Paula *P;                              // Snapshot of the Paula state
+    ModPlayer *Player;                     // Snapshot of the player state
+    sInt Warmup;                           // Frames to advance before output starts
+    sInt Frames;                           // Frames to render (less if the song ends)
+    sInt Done;                             // Frames actually rendered
+    sBool Finished;                        // Song ended within this chunk
+    sF32 *Buf;                             // Output (interleaved stereo)
+    ThreadPool::Group Group;               // Completion of this chunk
+};
+
+// Pool task: warm up and render one chunk
+static void chunk_run(void *parm, sInt worker)
+{
+    RenderChunk *c = (RenderChunk *)parm;
+    (void)worker;
+
+    c->Player->Advance(c->Warmup, 1);
+    c->Done = c->Player->Render(c->Buf, c->Frames);
+    c->Finished = c->Player->IsFinished();
+
+    // State is no longer needed, only the output
+    delete c->Player;
+    delete c->P;
+}
+
+// Take a snapshot of the pre-scan state and queue it for rendering
+static RenderChunk *chunk_submit(ThreadPool &pool, const Paula &p, const ModPlayer &player,
+                                 sInt warmup, sInt frames)
+{
+    RenderChunk *c = new RenderChunk;
+    c->P = new Paula(p);
+    c->Player = new ModPlayer(player, c->P);
+    c->Warmup = warmup;
+    c->Frames = frames;
+    c->Done = 0;
+    c->Finished = 0;
+    c->Buf = (sF32 *)malloc(sizeof(sF32) * 2 * frames);
+    pool.Submit(chunk_run, c, &c->Group);
+    return c;
+}
+
+// Wait for a chunk, pass its output on in blocks and free it
+static sBool chunk_finish(ThreadPool &pool, RenderChunk *c, const RenderOptions &opt,
+                          RenderBlockFunc func, void *parm, RenderResult &res, sBool ok)
+{
+    pool.Wait(c->Group);
+
+    for (sInt pos = 0; ok && pos < c->Done; pos += opt.BlockSize)
+        ok = func(parm, c->Buf + 2 * pos, sMin(opt.BlockSize, c->Done - pos));
+
+    res.Frames += c->Done;
+    if (c->Finished)
+        res.Finished = 1;
+
+    free(c->Buf);
+    delete c;
+    return ok;
+}
+
+// =================== render_module_parallel ===================
+static sBool render_module_parallel(const Module *mod, const RenderOptions &opt, RenderBlockFunc func,
+                                    void *parm, RenderResult &res)
+{
+    ThreadPool pool(opt.Threads);
+
+    // Pre-scan player: sequencer and voice positions only
+    Paula *paula = new Paula;
+    ModPlayer *player = new ModPlayer(paula, mod);
+    player->SetLoops(opt.Loops);
+    player->SetFadeOut(sInt(opt.FadeSeconds * OUTRATE));
+    player->SetMute(opt.Mute);
+
+    // Keep a bounded number of chunks in flight, write them in order
+    const sInt maxchunks = 2 * pool.GetThreadCount();
+    RenderChunk **chunks = new RenderChunk *[maxchunks];
+    sInt head = 0, count = 0;
+
+    sBool ok = 1;
+    sU64 limit = sU64(opt.MaxSeconds * OUTRATE);
+    sU64 pos = 0;                          // Pre-scan position
+    sU64 start = 0;                        // Start of the next chunk
+
+    while (ok && start < limit)
+    {
+        // Snapshot PARALLEL_WARMUP frames before the chunk start
+        sU64 snap = start > PARALLEL_WARMUP ? start - PARALLEL_WARMUP : 0;
+        if (snap > pos)
+        {
+            pos += player->Advance(sU32(snap - pos), 0);
+            if (pos < snap)
+                break;                     // Song ended before this chunk
+        }
+
+        // Hand the chunk to the pool
+        sInt frames = sInt(sMin<sU64>(PARALLEL_CHUNK_SIZE, limit - start));
+        if (count == maxchunks)
+        {
+            ok = chunk_finish(pool, chunks[head], opt, func, parm, res, ok);
+            head = (head + 1) % maxchunks;
+            count--;
+        }
+        chunks[(head + count++) % maxchunks] = chunk_submit(pool, *paula, *player, sInt(start - pos), frames);
+
+        // Continue the pre-scan up to the chunk start
+        if (start > pos)
+            pos += player->Advance(sU32(start - pos), 0);
+        start += frames;
+
+        if (player->IsFinished())
+            break;
+    }
+
+    // Drain remaining chunks in order
+    while (count)
+    {
+        ok = chunk_finish(pool, chunks[head], opt, func, parm, res, ok);
+        head = (head + 1) % maxchunks;
+        count--;
+    }
+
+    delete[] chunks;
+    delete player;
+    delete paula;
+    return ok;
+}
+
+// =================== render_serial ===================
+// Single timeline; with pcm set and an integer format, frames go straight
+// from ModPlayer::RenderPCM to the writer, bypassing func
+static sBool render_serial(const Module *mod, const RenderOptions &opt, RenderBlockFunc func, void *parm,
+                           WavWriter *pcm, RenderResult &res)
+{
+    // One player per call; the module itself is shared
+    Paula *paula = new Paula;
+    ModPlayer *player = new ModPlayer(paula, mod);
+    player->SetLoops(opt.Loops);
+    player->SetFadeOut(sInt(opt.FadeSeconds * OUTRATE));
+    player->SetMute(opt.Mute);
+
+    // Optional pipeline: voice generation on its own thread
+    Pipeline *pipeline = opt.Pipelined ? new Pipeline(player, paula) : NULL;
+
+    // Fused integer conversion (not behind a pipeline, which only delivers floats)
+    if (pipeline || opt.Format == FORMAT_F32)
+        pcm = NULL;
+    PcmDither dither;
+    pcm_dither_init(dither, opt.Dither);
+
+    // Optional parallel FIR: the rendering thread plus pool workers
+    ThreadPool *firpool = NULL;
+    if (opt.FIRThreads != 1 && !pipeline)
+    {
+        sInt threads = opt.FIRThreads > 0 ? opt.FIRThreads : ThreadPool::CoreCount();
+        firpool = new ThreadPool(sMax(threads - 1, 1));
+        paula->SetThreadPool(firpool);
+    }
+
+    // Render blocks until the song ends or the time limit is reached
+    size_t bytes = pcm ? 2 * format_bytes(opt.Format) : 2 * sizeof(sF32);
+    void *buf = malloc(bytes * opt.BlockSize);
+    sBool ok = buf != 0;
+    sU64 limit = sU64(opt.MaxSeconds * OUTRATE);
+    while (ok && res.Frames < limit)
+    {
+        sU32 todo = sU32(sMin<sU64>(opt.BlockSize, limit - res.Frames));
+        sU32 frames;
+        if (pcm)
+            frames = player->RenderPCM(buf, todo, opt.Format, &dither);
+        else if (pipeline)
+            frames = pipeline->Render((sF32 *)buf, todo);
+        else
+            frames = player->Render((sF32 *)buf, todo);
+
+        if (frames)
+            ok = pcm ? pcm->WritePCM(buf, frames) : func(parm, (sF32 *)buf, frames);
+        res.Frames += frames;
+
+        if (pipeline ? pipeline->IsFinished() : player->IsFinished())
+        {
+            res.Finished = 1;
+            break;
+        }
+    }
+
+    delete pipeline;
+    delete player;
+    delete paula;
+    delete firpool;
+    free(buf);
+    return ok;
+}
+
+// =================== render_module ===================
+sBool render_module(const Module *mod, const RenderOptions &opt, RenderBlockFunc func, void *parm,
+                    RenderResult &res)
+{
+    res.Frames = 0;
+    res.Seconds = 0;
+    res.Finished = 0;
+
+    sF64 start = sGetTime();
+    sBool ok = opt.Threads != 1 ? render_module_parallel(mod, opt, func, parm, res)
+                                : render_serial(mod, opt, func, parm, NULL, res);
+    res.Seconds = sGetTime() - start;
+    return ok;
+}
+
+// Block callback writing to a WavWriter
+static sBool write_block(void *parm, const sF32 *buf, sInt frames)
+{
+    return ((WavWriter *)parm)->Write(buf, frames);
+}
+
+// =================== render_to_file ===================
+sBool render_to_file(const Module *mod, FILE *out, const RenderOptions &opt, RenderResult &res)
+{
+    res.Frames = 0;
+    res.Seconds = 0;
+    res.Finished = 0;
+
+    WavWriter wav;
+    sBool ok = wav.Open(out, opt.Format, 2, OUTRATE, opt.Raw);
+    wav.SetDither(opt.Dither);
+
+    if (ok && opt.Threads == 1)
+    {
+        sF64 start = sGetTime();
+        ok = render_serial(mod, opt, write_block, &wav, &wav, res);
+        res.Seconds = sGetTime() - start;
+    }
+    else if (ok)
+        ok = render_module(mod, opt, write_block, &wav, res);
+
+    if (!wav.Close())
+        ok = 0;
+    return ok;
+}
@@ -0,0 +1,58 @@
+// =================== Offline Renderer ===================
+// Renders a MOD file to a WAV/raw file as fast as the CPU allows
+// Runs ModPlayer::Render in large blocks and stops at the song end
+
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <stdio.h>
+#include "types.h"
+#include "config.h"
+#include "module.h"
+
+// =================== Render Options ===================
+struct RenderOptions
+{
+    sInt Format;                           // Output sample format (SampleFormat)
+    sBool Raw;                             // Write headerless raw PCM
+    sInt Loops;                            // Passes through the song (0 = until MaxSeconds)
+    sF32 FadeSeconds;                      // Fade-out tail after the last loop
+    sF32 MaxSeconds;                       // Upper limit on rendered duration
+    sInt BlockSize;                        // Frames rendered per ModPlayer::Render call
+    sInt Threads;                          // Threads splitting the timeline (1 = serial, 0 = all cores)
+    sInt FIRThreads;                       // Threads sharing the FIR of each block (1 = serial, 0 = all cores)
+    sBool Pipelined;                       // Generate voices on a producer thread, FIR on the caller
+    sBool Dither;                          // TPDF dither for integer sample formats
+    sInt Mute;                             // Muted channels (bit i = channel i + 1)
+};
+
+// =================== Render Result ===================
+struct RenderResult
+{
+    sU64 Frames;                           // Frames written to the output
+    sF64 Seconds;                          // Wall clock time spent rendering
+    sBool Finished;                        // Stopped at the detected song end
+};
+
+// Receives each rendered block of interleaved stereo frames
+// Returns false to abort rendering
+typedef sBool (*RenderBlockFunc)(void *parm, const sF32 *buf, sInt frames);
+
+// Fill in default render options (play once, float WAV)
+void render_defaults(RenderOptions &opt);
+
+// Render a parsed module, handing each block to func
+// Player state lives on the heap, so this is safe to run on worker threads
+// With opt.Threads != 1 the song is pre-scanned and rendered in chunks on
+// a thread pool; the output is identical to the serial render
+// Returns false if the module could not be set up or func aborted
+sBool render_module(const Module *mod, const RenderOptions &opt, RenderBlockFunc func, void *parm,
+                    RenderResult &res);
+
+// Render a parsed module to an open output file
+// Integer formats are converted tile by tile as they are rendered
+// (serial, non-pipelined renders), otherwise block by block
+// Returns false on write errors
+sBool render_to_file(const Module *mod, FILE *out, const RenderOptions &opt, RenderResult &res);
+
+#endif // RENDER_H
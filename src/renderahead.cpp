@@ -0,0 +1,211 @@
+// =================== Render-Ahead Buffer Implementation ===================
+
+#include "renderahead.h"
+#include "config.h"
+#include <stdlib.h>
+
+// =================== RenderAhead Constructor/Destructor ===================
+RenderAhead::RenderAhead()
+    : Queue(0), Size(0), LowFrames(0), HighFrames(0), BlockFrames(0), GuardFrames(0), Func(0),
+      Rewind(0), Parm(0), Monitor(0), ReadPos(0), WritePos(0), Filling(1), SourceDone(0), InvalidateReq(0),
+      Quit(0), Primed(0), Refills(0), Stalls(0), Invalidations(0), MinFill(~sU64(0))
+{
+}
+
+RenderAhead::~RenderAhead()
+{
+    Stop();
+    free(Queue);
+}
+
+// =================== RenderAhead::Open ===================
+sBool RenderAhead::Open(sInt horizon, sInt lowframes, sInt blockframes, StreamRenderFunc func,
+                        StreamRewindFunc rewind, void *parm)
+{
+    // Power of 2 queue holding the horizon plus one block
+    Size = 1;
+    while (Size < horizon + blockframes)
+        Size *= 2;
+
+    HighFrames = horizon;
+    LowFrames = sClamp(lowframes, 0, horizon);
+    BlockFrames = blockframes;
+    GuardFrames = RENDER_AHEAD_GUARD;
+    Func = func;
+    Rewind = rewind;
+    Parm = parm;
+
+    Queue = (sF32 *)malloc(sizeof(sF32) * 2 * Size);
+    return Queue != 0;
+}
+
+// =================== RenderAhead::RenderLoop ===================
+void RenderAhead::RenderLoop()
+{
+    std::unique_lock<std::mutex> lock(Lock);
+    while (!Quit)
+    {
+        // === Invalidation ===
+        // Keep what is about to be played, rewind the source behind it
+        if (InvalidateReq)
+        {
+            InvalidateReq = 0;
+            if (!Rewind)
+                continue;
+
+            sU64 target = sMin(ReadPos + GuardFrames, WritePos);
+            lock.unlock();
+            sU64 pos = Rewind(Parm, target);
+            lock.lock();
+
+            WritePos = sMin(pos, WritePos);
+            SourceDone = 0;
+            Filling = 1;
+            Invalidations++;
+            continue;
+        }
+
+        // === Watermarks ===
+        sU64 fill = WritePos > ReadPos ? WritePos - ReadPos : 0;
+        if (!Filling && fill < sU64(LowFrames))
+        {
+            Filling = 1;
+            Refills++;
+        }
+        if (Filling && fill >= sU64(HighFrames))
+        {
+            Filling = 0;
+            Primed = 1;
+        }
+
+        if (SourceDone || !Filling)
+        {
+            Space.wait(lock);
+            continue;
+        }
+
+        // === Render One Block ===
+        // Straight into the queue: the consumer never reads at or past WritePos
+        sInt offs = sInt(WritePos & (Size - 1));
+        sU32 todo = sU32(sMin<sU64>(sMin(BlockFrames, Size - offs), Size - fill));
+        lock.unlock();
+        sF64 start = sGetTime();
+        sU32 got = Func(Parm, Queue + 2 * offs, todo);
+        if (Monitor)
+            Monitor->Record(sGetTime() - start, sInt(got));
+        lock.lock();
+
+        // Invalidated meanwhile: the block is stale, the rewind redoes it
+        if (InvalidateReq)
+            continue;
+
+        // After a rewind the consumer may already have played past the
+        // rewind point; those frames are skipped, not queued
+        WritePos += got;
+        if (got < todo)
+            SourceDone = 1;
+        Data.notify_all();
+    }
+}
+
+// =================== RenderAhead::SetMonitor ===================
+void RenderAhead::SetMonitor(HeadroomMonitor *mon)
+{
+    Monitor = mon;
+}
+
+// =================== RenderAhead::Start ===================
+void RenderAhead::Start()
+{
+    Renderer = std::thread(&RenderAhead::RenderLoop, this);
+}
+
+// =================== RenderAhead::Stop ===================
+void RenderAhead::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(Lock);
+        Quit = 1;
+    }
+    Space.notify_all();
+    Data.notify_all();
+    if (Renderer.joinable())
+        Renderer.join();
+}
+
+// =================== RenderAhead::Render ===================
+sU32 RenderAhead::Render(sF32 *buf, sU32 frames)
+{
+    std::unique_lock<std::mutex> lock(Lock);
+    sU32 done = 0;
+    while (done < frames && !Quit)
+    {
+        sU64 avail = WritePos > ReadPos ? WritePos - ReadPos : 0;
+        if (!avail)
+        {
+            if (SourceDone)
+                break;
+            if (Primed)
+                Stalls++;                  // A spike the queue did not absorb
+            Data.wait(lock);
+            continue;
+        }
+        if (Primed && !SourceDone)
+            MinFill = sMin(MinFill, avail);
+
+        // Copied under the lock so an invalidation cannot overwrite it
+        sInt offs = sInt(ReadPos & (Size - 1));
+        sU32 n = sU32(sMin<sU64>(sMin<sU64>(avail, frames - done), Size - offs));
+        sCopyMem(buf + 2 * done, Queue + 2 * offs, sizeof(sF32) * 2 * n);
+        ReadPos += n;
+        done += n;
+
+        if (avail - n < sU64(LowFrames))
+            Space.notify_one();
+    }
+
+    if (done < frames)
+        sZeroMem(buf + 2 * done, sizeof(sF32) * 2 * (frames - done));
+    return done;
+}
+
+// =================== RenderAhead::Invalidate ===================
+void RenderAhead::Invalidate()
+{
+    {
+        std::lock_guard<std::mutex> lock(Lock);
+        InvalidateReq = 1;
+    }
+    Space.notify_one();
+}
+
+// =================== RenderAhead Statistics ===================
+sU64 RenderAhead::GetRefills()
+{
+    std::lock_guard<std::mutex> lock(Lock);
+    return Refills;
+}
+
+sU64 RenderAhead::GetStalls()
+{
+    std::lock_guard<std::mutex> lock(Lock);
+    return Stalls;
+}
+
+sU64 RenderAhead::GetInvalidations()
+{
+    std::lock_guard<std::mutex> lock(Lock);
+    return Invalidations;
+}
+
+sU64 RenderAhead::GetMinFill()
+{
+    std::lock_guard<std::mutex> lock(Lock);
+    return MinFill == ~sU64(0) ? 0 : MinFill;
+}
+
+// =================== RenderAhead::RenderProxy ===================
+sU32 RenderAhead::RenderProxy(void *parm, sF32 *buf, sU32 frames)
+{
+    return ((RenderAhead *)parm)->Render(buf, frames);
+}
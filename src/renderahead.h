@@ -0,0 +1,102 @@
+// =================== Render-Ahead Buffer ===================
+// Keeps seconds of rendered audio queued in memory, so a scheduling
+// hiccup or a CPU spike while rendering no longer reaches the output.
+// A background thread refills the queue in bursts: once the fill drops
+// below the low watermark it renders until the high watermark is reached.
+// Queued audio can be invalidated (after a seek or a volume/separation
+// change); the source is then rewound to just after the frames about to
+// be played and the rest of the queue is rendered again.
+// Reading the queue costs next to nothing, so the render time that tells
+// how much headroom playback has is measured here, around each block the
+// background thread renders (see SetMonitor()).
+
+#ifndef RENDERAHEAD_H
+#define RENDERAHEAD_H
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "types.h"
+#include "streamout.h"
+
+// Restart the source so that the next rendered frame is stream frame
+// frame (counting from the start of the stream) with the current settings
+// Returns the frame rendering actually continues from: at least frame and
+// at most the frames rendered so far (a source that cannot go back that
+// far returns a later frame; the queued audio before it is kept)
+typedef sU64 (*StreamRewindFunc)(void *parm, sU64 frame);
+
+// =================== RenderAhead Class ===================
+class RenderAhead
+{
+private:
+    sF32 *Queue;                           // Queued frames (interleaved stereo ring)
+    sInt Size;                             // Queue size in frames (power of 2)
+    sInt LowFrames;                        // Start refilling below this fill
+    sInt HighFrames;                       // Stop refilling at this fill
+    sInt BlockFrames;                      // Frames rendered per source call
+    sInt GuardFrames;                      // Queued frames kept on invalidation
+
+    StreamRenderFunc Func;                 // Audio source
+    StreamRewindFunc Rewind;               // Source rewind (NULL = cannot invalidate)
+    void *Parm;                            // Audio source parameter
+    HeadroomMonitor *Monitor;              // Receives render times (NULL = none)
+
+    std::thread Renderer;                  // Background render thread
+    std::mutex Lock;                       // Guards everything below
+    std::condition_variable Space;         // Consumer drained below the low watermark
+    std::condition_variable Data;          // Render thread queued frames
+    sU64 ReadPos;                          // Stream frames consumed
+    sU64 WritePos;                         // Stream frames queued
+    sBool Filling;                         // Between low and high watermark
+    sBool SourceDone;                      // Source has ended at WritePos
+    sBool InvalidateReq;                   // Invalidation pending
+    sBool Quit;                            // Stop the render thread
+    sBool Primed;                          // High watermark was reached once
+
+    // Statistics
+    sU64 Refills;                          // Low watermark crossings
+    sU64 Stalls;                           // Reads that found the queue empty
+    sU64 Invalidations;                    // Invalidations carried out
+    sU64 MinFill;                          // Lowest fill seen while the source was live
+
+    // Render thread main loop
+    void RenderLoop();
+
+public:
+    RenderAhead();
+    ~RenderAhead();
+
+    // Set up a queue of horizon frames, refilled from below lowframes
+    // (rewind may be NULL if the source cannot be rewound)
+    sBool Open(sInt horizon, sInt lowframes, sInt blockframes, StreamRenderFunc func,
+               StreamRewindFunc rewind, void *parm);
+
+    // Record the render time of every block in mon (before Start())
+    void SetMonitor(HeadroomMonitor *mon);
+
+    // Start the background render thread
+    void Start();
+
+    // Stop the render thread (also releases a waiting Render() call)
+    void Stop();
+
+    // Copy queued frames out, waiting while the queue is empty
+    // Returns fewer frames than requested only at the end of the source
+    sU32 Render(sF32 *buf, sU32 frames);
+
+    // Drop queued audio after a guard interval and render it again
+    // Safe to call from any thread; returns immediately
+    void Invalidate();
+
+    // Statistics (MinFill in frames)
+    sU64 GetRefills();
+    sU64 GetStalls();
+    sU64 GetInvalidations();
+    sU64 GetMinFill();
+
+    // StreamRenderFunc adapter
+    static sU32 RenderProxy(void *parm, sF32 *buf, sU32 frames);
+};
+
+#endif // RENDERAHEAD_H
@@ -0,0 +1,167 @@
+// =================== Audio Sinks Implementation ===================
+
+#include "sink.h"
+#include "config.h"
+#include <stdlib.h>
+#include <chrono>
+
+// =================== sink_parse ===================
+sInt sink_parse(const char *name)
+{
+    if (!strcmp(name, "portaudio"))
+        return SINK_PORTAUDIO;
+    if (!strcmp(name, "null"))
+        return SINK_NULL;
+    if (!strcmp(name, "null-paced"))
+        return SINK_NULL_PACED;
+    if (!strcmp(name, "wav"))
+        return SINK_WAV;
+    if (!strcmp(name, "stdout"))
+        return SINK_STDOUT;
+    return -1;
+}
+
+// =================== PortAudioSink ===================
+PortAudioSink::PortAudioSink(const PaStreamParameters &params)
+    : Params(params), Stream(0)
+{
+}
+
+PortAudioSink::~PortAudioSink()
+{
+    Stop();
+}
+
+int PortAudioSink::Callback(const void *input, void *output, unsigned long frames,
+                            const PaStreamCallbackTimeInfo *timeinfo, PaStreamCallbackFlags flags,
+                            void *userdata)
+{
+    (void)input;
+    (void)timeinfo;
+
+    StreamOutput *out = (StreamOutput *)userdata;
+    if (flags & paOutputUnderflow)
+        out->AddDeviceUnderflow();         // The device ran dry before this callback
+    out->Pull((sF32 *)output, sInt(frames));
+    return paContinue;
+}
+
+sBool PortAudioSink::Start(StreamOutput *out)
+{
+    PaError err = Pa_OpenStream(&Stream, NULL, &Params, out->GetRate(),
+                                paFramesPerBufferUnspecified, paClipOff, Callback, out);
+    if (err != paNoError)
+    {
+        Stream = 0;                        // Not guaranteed to be set on failure
+        fprintf(stderr, "PortAudio Error: %s\n", Pa_GetErrorText(err));
+        return 0;
+    }
+
+    err = Pa_StartStream(Stream);
+    if (err != paNoError)
+    {
+        // Close the stream here so Stop() doesn't wait on or stop a dead stream
+        Pa_CloseStream(Stream);
+        Stream = 0;
+        fprintf(stderr, "PortAudio Error: %s\n", Pa_GetErrorText(err));
+        return 0;
+    }
+    return 1;
+}
+
+sBool PortAudioSink::Stop()
+{
+    if (!Stream)
+        return 1;
+
+    // Let the device play out its own buffers before stopping
+    Pa_Sleep(sInt(GetLatency() * 1000) + 100);
+
+    PaError err = Pa_StopStream(Stream);
+    PaError err2 = Pa_CloseStream(Stream);
+    Stream = 0;
+    return err == paNoError && err2 == paNoError;
+}
+
+sF64 PortAudioSink::GetLatency() const
+{
+    const PaStreamInfo *info = Stream ? Pa_GetStreamInfo(Stream) : NULL;
+    return info ? info->outputLatency : 0;
+}
+
+// =================== PumpSink ===================
+PumpSink::PumpSink(sBool paced, FILE *file, sBool own, sInt format, sBool raw, sBool dither)
+    : Paced(paced), File(file), OwnFile(own), Format(format), Raw(raw), Dither(dither), Out(0), Quit(0),
+      Failed(0)
+{
+}
+
+PumpSink::~PumpSink()
+{
+    Stop();
+}
+
+void PumpSink::PumpLoop()
+{
+    sInt block = Out->GetBlockFrames();
+    sF32 *buf = (sF32 *)malloc(sizeof(sF32) * 2 * block);
+    sF64 start = sGetTime();
+    sU64 frames = 0;
+
+    while (!Quit.load(std::memory_order_relaxed) && !Out->IsDone())
+    {
+        if (Paced)
+        {
+            // Consume like a device would: one block per block duration
+            sF64 due = start + sF64(frames) / Out->GetRate();
+            sF64 wait = due - sGetTime();
+            if (wait > 0)
+                std::this_thread::sleep_for(std::chrono::microseconds(sInt(wait * 1e6)));
+            Out->Pull(buf, block);
+            frames += block;
+            continue;
+        }
+
+        sInt got = Out->PullWait(buf, block);
+        if (File && got && !Wav.Write(buf, got))
+        {
+            Failed = 1;
+            break;
+        }
+    }
+    free(buf);
+}
+
+sBool PumpSink::Start(StreamOutput *out)
+{
+    Out = out;
+    if (File && !Wav.Open(File, Format, 2, out->GetRate(), Raw))
+        return 0;
+    Wav.SetDither(Dither);
+
+    Pump = std::thread(&PumpSink::PumpLoop, this);
+    return 1;
+}
+
+sBool PumpSink::Stop()
+{
+    Quit = 1;
+    if (Pump.joinable())
+        Pump.join();
+
+    sBool ok = !Failed;
+    if (File)
+    {
+        if (!Wav.Close())
+            ok = 0;
+        if (OwnFile && fclose(File) != 0)
+            ok = 0;
+        File = 0;
+    }
+    return ok;
+}
+
+sBool PumpSink::IsRealtime() const
+{
+    return Paced;
+}
@@ -0,0 +1,105 @@
+// =================== Audio Sinks ===================
+// Consumers for a StreamOutput: a PortAudio device, or headless sinks
+// that discard the audio (as fast as possible or paced to realtime) or
+// write it to a WAV file or stdout. All of them see the identical render
+// pipeline, so playback can be timed on machines without sound hardware.
+
+#ifndef SINK_H
+#define SINK_H
+
+#include <stdio.h>
+#include <atomic>
+#include <thread>
+#include <portaudio.h>
+#include "types.h"
+#include "streamout.h"
+#include "wavwriter.h"
+
+// =================== Sink Types ===================
+enum SinkType
+{
+    SINK_PORTAUDIO,                        // Default PortAudio output device
+    SINK_NULL,                             // Discard at maximum speed
+    SINK_NULL_PACED,                       // Discard, paced to realtime
+    SINK_WAV,                              // Write a WAV/raw file
+    SINK_STDOUT,                           // Write WAV/raw to stdout
+};
+
+// Parse a sink name ("portaudio", "null", "null-paced", "wav", "stdout"),
+// returns -1 if unknown
+sInt sink_parse(const char *name);
+
+// =================== AudioSink Class ===================
+// Pulls frames from a started StreamOutput until it is done
+class AudioSink
+{
+public:
+    virtual ~AudioSink() {}
+
+    // Start consuming; returns false on errors
+    virtual sBool Start(StreamOutput *out) = 0;
+
+    // Stop consuming (after the stream is done); returns false on errors
+    virtual sBool Stop() = 0;
+
+    // Output latency in seconds beyond the ring buffer
+    virtual sF64 GetLatency() const { return 0; }
+
+    // Consumes in realtime (underruns are meaningful)
+    virtual sBool IsRealtime() const { return 1; }
+};
+
+// =================== PortAudioSink Class ===================
+// Callback stream; the callback only calls StreamOutput::Pull
+class PortAudioSink : public AudioSink
+{
+private:
+    PaStreamParameters Params;             // Output device parameters
+    PaStream *Stream;                      // Callback stream
+
+    static int Callback(const void *input, void *output, unsigned long frames,
+                        const PaStreamCallbackTimeInfo *timeinfo, PaStreamCallbackFlags flags,
+                        void *userdata);
+
+public:
+    // PortAudio must be initialized
+    PortAudioSink(const PaStreamParameters &params);
+    ~PortAudioSink();
+
+    sBool Start(StreamOutput *out);
+    sBool Stop();
+    sF64 GetLatency() const;
+};
+
+// =================== PumpSink Class ===================
+// Headless sink: a thread pulls blocks and discards or writes them
+class PumpSink : public AudioSink
+{
+private:
+    sBool Paced;                           // Consume at realtime speed
+    FILE *File;                            // Output file (NULL = discard)
+    sBool OwnFile;                         // Close File when done
+    WavWriter Wav;                         // Output writer (if File)
+    sInt Format;                           // Sample format (SampleFormat)
+    sBool Raw;                             // Write headerless raw PCM
+    sBool Dither;                          // TPDF dither for integer formats
+
+    StreamOutput *Out;                     // Source
+    std::thread Pump;                      // Pump thread
+    std::atomic<sBool> Quit;               // Stop the pump thread
+    std::atomic<sBool> Failed;             // Write error
+
+    // Pump thread main loop
+    void PumpLoop();
+
+public:
+    // file: output file (NULL = discard), closed by Stop() if own is set
+    PumpSink(sBool paced, FILE *file, sBool own, sInt format, sBool raw, sBool dither);
+    ~PumpSink();
+
+    sBool Start(StreamOutput *out);
+    sBool Stop();
+    sBool IsRealtime() const;
+};
+
+#endif // SINK_H
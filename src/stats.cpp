@@ -0,0 +1,101 @@
+// =================== Render Stage Statistics Implementation ===================
+
+#include "stats.h"
+#include <unistd.h>
+
+#if TINYMOD_STATS
+
+StatsCounter StatsCounters[STATS_STAGES];
+
+// Counter rate: the TSC is calibrated against the wall clock since
+// program start (at least 10ms), clock_gettime already counts ns
+static const sU64 StartCount = stats_now();
+static const sF64 StartTime = sGetTime();
+
+static sF64 counts_per_second()
+{
+#ifdef STATS_TSC
+    static sF64 rate = 0;
+    if (rate == 0)
+    {
+        while (sGetTime() - StartTime < 0.01)
+            usleep(1000);
+        rate = sF64(stats_now() - StartCount) / (sGetTime() - StartTime);
+    }
+    return rate;
+#else
+    return 1e9;
+#endif
+}
+
+#endif
+
+// =================== stats_enabled ===================
+sBool stats_enabled()
+{
+    return TINYMOD_STATS;
+}
+
+// =================== stats_get ===================
+void stats_get(StageStats stats[STATS_STAGES])
+{
+    for (sInt i = 0; i < STATS_STAGES; i++)
+    {
+#if TINYMOD_STATS
+        const StatsCounter &c = StatsCounters[i];
+        stats[i].Calls = c.Calls.load(std::memory_order_relaxed);
+        stats[i].Samples = c.Samples.load(std::memory_order_relaxed);
+        stats[i].Seconds = sF64(c.Time.load(std::memory_order_relaxed)) / counts_per_second();
+#else
+        stats[i].Calls = 0;
+        stats[i].Samples = 0;
+        stats[i].Seconds = 0;
+#endif
+    }
+}
+
+// =================== stats_reset ===================
+void stats_reset()
+{
+#if TINYMOD_STATS
+    for (sInt i = 0; i < STATS_STAGES; i++)
+    {
+        StatsCounters[i].Calls = 0;
+        StatsCounters[i].Samples = 0;
+        StatsCounters[i].Time = 0;
+    }
+#endif
+}
+
+// =================== stats_stage_name ===================
+const char *stats_stage_name(sInt stage)
+{
+    static const char *names[STATS_STAGES] = { "tick", "voices", "fir" };
+    return (stage >= 0 && stage < STATS_STAGES) ? names[stage] : "?";
+}
+
+// =================== stats_print ===================
+void stats_print(FILE *out, const StageStats *now, const StageStats *prev, sF64 wall)
+{
+    if (!stats_enabled())
+    {
+        fprintf(out, "Stage statistics were compiled out (TINYMOD_STATS=0)\n");
+        return;
+    }
+
+    // Ticks are few and expensive: cost per call; the others per sample
+    for (sInt i = 0; i < STATS_STAGES; i++)
+    {
+        sU64 calls = now[i].Calls - (prev ? prev[i].Calls : 0);
+        sU64 samples = now[i].Samples - (prev ? prev[i].Samples : 0);
+        sF64 secs = now[i].Seconds - (prev ? prev[i].Seconds : 0);
+
+        sF64 share = wall > 0 ? 100.0 * secs / wall : 0;
+        if (i == STATS_TICK)
+            fprintf(out, "%s %.1f%% (%.2f us/call)", stats_stage_name(i), share, calls ? secs * 1e6 / calls : 0);
+        else
+            fprintf(out, "%s %.1f%% (%.2f ns/%s)", stats_stage_name(i), share, samples ? secs * 1e9 / samples : 0,
+                    i == STATS_FIR ? "frame" : "sample");
+        fprintf(out, i + 1 < STATS_STAGES ? ", " : "\n");
+    }
+}
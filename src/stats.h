@@ -0,0 +1,98 @@
+// =================== Render Stage Statistics ===================
+// Low-overhead timing of the render stages: the sequencer
+// (ModPlayer::Tick), voice generation (Paula::CalcFrag) and the FIR
+// (Paula::Render, RenderParallel and FilterStream). Each instrumented
+// call adds its elapsed time, one call and the samples it produced to
+// process-wide counters. Time is read from the CPU time stamp counter
+// where there is one, otherwise from clock_gettime.
+// Build with -DTINYMOD_STATS=0 to compile the instrumentation out.
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+#include <atomic>
+#include "types.h"
+#include "config.h"
+
+#if TINYMOD_STATS && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define STATS_TSC
+#endif
+
+// =================== Stages ===================
+enum StatsStage
+{
+    STATS_TICK,                            // ModPlayer::Tick (samples: frames per tick)
+    STATS_VOICES,                          // Paula::CalcFrag (samples: Paula-rate samples)
+    STATS_FIR,                             // FIR filtering (samples: output frames)
+    STATS_STAGES
+};
+
+// Totals of one stage
+struct StageStats
+{
+    sU64 Calls;                            // Instrumented calls
+    sU64 Samples;                          // Samples produced (unit depends on the stage)
+    sF64 Seconds;                          // Time spent, summed over all threads
+};
+
+// =================== Counters ===================
+#if TINYMOD_STATS
+
+struct StatsCounter
+{
+    std::atomic<sU64> Calls;
+    std::atomic<sU64> Samples;
+    std::atomic<sU64> Time;                // In stats_now() units
+};
+extern StatsCounter StatsCounters[STATS_STAGES];
+
+// Current time in counter units (TSC cycles or nanoseconds)
+inline sU64 stats_now()
+{
+#ifdef STATS_TSC
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return sU64(ts.tv_sec) * 1000000000ULL + sU64(ts.tv_nsec);
+#endif
+}
+
+// Account one call of a stage that started at stats_now() == start
+inline void stats_add(sInt stage, sU64 start, sU64 samples)
+{
+    StatsCounter &c = StatsCounters[stage];
+    c.Time.fetch_add(stats_now() - start, std::memory_order_relaxed);
+    c.Calls.fetch_add(1, std::memory_order_relaxed);
+    c.Samples.fetch_add(samples, std::memory_order_relaxed);
+}
+
+#else
+
+inline sU64 stats_now() { return 0; }
+inline void stats_add(sInt, sU64, sU64) {}
+
+#endif
+
+// =================== Queries ===================
+
+// Returns false if the instrumentation was compiled out
+sBool stats_enabled();
+
+// Read the totals of all stages
+void stats_get(StageStats stats[STATS_STAGES]);
+
+// Reset all counters to zero
+void stats_reset();
+
+// Short stage name ("tick", "voices", "fir")
+const char *stats_stage_name(sInt stage);
+
+// Print one line with each stage's share of wall seconds and its cost
+// per call or sample, for the interval between two snapshots (prev may
+// be NULL to print the totals)
+void stats_print(FILE *out, const StageStats *now, const StageStats *prev, sF64 wall);
+
+#endif // STATS_H
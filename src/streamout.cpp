@@ -0,0 +1,209 @@
+// =================== Stream Output Implementation ===================
+
+#include "streamout.h"
+#include <stdlib.h>
+#include <chrono>
+
+// =================== StreamOutput Constructor/Destructor ===================
+StreamOutput::StreamOutput()
+    : Rate(0), BlockFrames(0), MaxFrames(0), Rendered(0), Timed(1), Func(0), Parm(0), Block(0), Quit(0),
+      SourceDone(0), Played(0)
+{
+}
+
+StreamOutput::~StreamOutput()
+{
+    Stop();
+    free(Block);
+}
+
+// =================== StreamOutput::Open ===================
+sBool StreamOutput::Open(sInt rate, sInt ringframes, sInt blockframes, StreamRenderFunc func,
+                         void *parm, sU64 maxframes)
+{
+    Rate = rate;
+    Monitor.SetRate(rate);
+    BlockFrames = blockframes;
+    MaxFrames = maxframes;
+    Func = func;
+    Parm = parm;
+
+    Block = (sF32 *)malloc(sizeof(sF32) * 2 * BlockFrames);
+    return Block && Ring.Init(sMax(ringframes, 2 * BlockFrames));
+}
+
+// =================== StreamOutput::RenderBlock ===================
+sBool StreamOutput::RenderBlock()
+{
+    sU32 todo = sU32(sMin<sU64>(BlockFrames, MaxFrames - Rendered));
+
+    sF64 start = sGetTime();
+    sU32 frames = todo ? Func(Parm, Block, todo) : 0;
+    sF64 time = sGetTime() - start;
+    Ring.Write(Block, frames);
+
+    if (Timed)
+        Monitor.Record(time, sInt(frames));
+    Rendered += frames;
+
+    sBool more = frames == todo && todo > 0;
+    if (!more)
+        SourceDone.store(1, std::memory_order_release);
+
+    // Wake a PullWait() consumer
+    {
+        std::lock_guard<std::mutex> lock(WakeLock);
+    }
+    Ready.notify_one();
+    return more;
+}
+
+// =================== StreamOutput::RenderLoop ===================
+// Top up the ring whenever a whole block fits, otherwise sleep for
+// about half a block (or until a non-realtime consumer made room)
+void StreamOutput::RenderLoop()
+{
+    const sInt nap = sMax(BlockFrames * 500000 / Rate, 100);   // Microseconds
+
+    while (!Quit.load(std::memory_order_relaxed))
+    {
+        if (Ring.GetFree() < BlockFrames)
+        {
+            std::unique_lock<std::mutex> lock(WakeLock);
+            Wake.wait_for(lock, std::chrono::microseconds(nap),
+                          [this] { return Quit || Ring.GetFree() >= BlockFrames; });
+            continue;
+        }
+        if (!RenderBlock())
+            break;
+    }
+}
+
+// =================== StreamOutput::Start ===================
+void StreamOutput::Start()
+{
+    // Prefill so playback does not start with an underrun
+    sBool more = 1;
+    while (more && Ring.GetFree() >= BlockFrames)
+        more = RenderBlock();
+
+    if (more)
+        Renderer = std::thread(&StreamOutput::RenderLoop, this);
+}
+
+// =================== StreamOutput::Stop ===================
+void StreamOutput::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(WakeLock);
+        Quit = 1;
+    }
+    Wake.notify_one();
+    if (Renderer.joinable())
+        Renderer.join();
+}
+
+// =================== StreamOutput::Pull ===================
+void StreamOutput::Pull(sF32 *buf, sInt frames)
+{
+    // Read the done flag first, so frames written before it are seen
+    sBool done = SourceDone.load(std::memory_order_acquire);
+    sInt got = Ring.Read(buf, frames);
+    Played.fetch_add(got, std::memory_order_relaxed);
+
+    if (got < frames)
+    {
+        sZeroMem(buf + 2 * got, sizeof(sF32) * 2 * (frames - got));
+        if (!done)
+            Monitor.AddUnderrun(frames - got);
+    }
+}
+
+// =================== StreamOutput::PullWait ===================
+// Not for audio callbacks: may take the wake lock
+sInt StreamOutput::PullWait(sF32 *buf, sInt frames)
+{
+    sInt got = 0;
+    while (got < frames)
+    {
+        sBool done = SourceDone.load(std::memory_order_acquire);
+        got += Ring.Read(buf + 2 * got, frames - got);
+        if (done && !Ring.GetFill())
+            break;
+        if (got < frames)
+        {
+            // Wake the render thread rather than wait for its nap to end,
+            // then sleep until it has rendered the next block
+            std::unique_lock<std::mutex> lock(WakeLock);
+            Wake.notify_one();
+            Ready.wait_for(lock, std::chrono::milliseconds(10),
+                           [this] { return SourceDone || Ring.GetFill() > 0; });
+        }
+    }
+    Played.fetch_add(got, std::memory_order_relaxed);
+    return got;
+}
+
+// =================== StreamOutput Accessors ===================
+sBool StreamOutput::IsDone() const
+{
+    return SourceDone.load(std::memory_order_acquire) && !Ring.GetFill();
+}
+
+sInt StreamOutput::GetRate() const
+{
+    return Rate;
+}
+
+sInt StreamOutput::GetBlockFrames() const
+{
+    return BlockFrames;
+}
+
+sU64 StreamOutput::GetPlayedFrames() const
+{
+    return Played.load(std::memory_order_relaxed);
+}
+
+sU64 StreamOutput::GetUnderruns() const
+{
+    HeadroomStats s;
+    Monitor.GetStats(s);
+    return s.Underruns;
+}
+
+sU64 StreamOutput::GetUnderrunFrames() const
+{
+    HeadroomStats s;
+    Monitor.GetStats(s);
+    return s.UnderrunFrames;
+}
+
+void StreamOutput::GetRenderCost(sF64 &avg, sF64 &peak) const
+{
+    HeadroomStats s;
+    Monitor.GetStats(s);
+    avg = s.Blocks ? s.TotalTime / s.Blocks : 0;
+    peak = s.MaxTime;
+}
+
+void StreamOutput::AddDeviceUnderflow()
+{
+    Monitor.AddDeviceUnderflow();
+}
+
+const HeadroomMonitor &StreamOutput::GetMonitor() const
+{
+    return Monitor;
+}
+
+HeadroomMonitor &StreamOutput::GetMonitor()
+{
+    return Monitor;
+}
+
+// =================== StreamOutput::SetTimed ===================
+void StreamOutput::SetTimed(sBool timed)
+{
+    Timed = timed;
+}
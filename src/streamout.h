@@ -0,0 +1,108 @@
+// =================== Stream Output ===================
+// Decouples rendering from the audio output. A dedicated render thread
+// keeps an AudioRing topped up; an audio sink pulls frames out of it.
+// Pull() is safe inside an audio driver callback (no allocation, no
+// locks, no calls into the player) and counts underruns when the ring
+// runs dry. Render times and underruns go to a HeadroomMonitor.
+// A source that only copies audio rendered elsewhere (RenderAhead) is not
+// timed; its renderer records into the monitor instead.
+
+#ifndef STREAMOUT_H
+#define STREAMOUT_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "types.h"
+#include "audioring.h"
+#include "headroom.h"
+
+// Renders up to frames interleaved stereo frames into buf
+// Returns the number of frames produced; fewer than requested ends the stream
+typedef sU32 (*StreamRenderFunc)(void *parm, sF32 *buf, sU32 frames);
+
+// =================== StreamOutput Class ===================
+class StreamOutput
+{
+private:
+    AudioRing Ring;                        // Render thread -> sink
+    sInt Rate;                             // Output sample rate
+    sInt BlockFrames;                      // Frames per render call
+    sU64 MaxFrames;                        // Stop the source after this many frames
+    sU64 Rendered;                         // Frames written to the ring (render thread)
+    sBool Timed;                           // Record the source's render times in Monitor
+
+    StreamRenderFunc Func;                 // Audio source
+    void *Parm;                            // Audio source parameter
+    sF32 *Block;                           // Render thread scratch buffer
+    std::thread Renderer;                  // Render thread
+    std::atomic<sBool> Quit;               // Stop the render thread
+    std::atomic<sBool> SourceDone;         // Source has ended, no more frames will come
+    std::mutex WakeLock;                   // Guards render thread and PullWait() naps
+    std::condition_variable Wake;          // PullWait() freed ring space
+    std::condition_variable Ready;         // Render thread added frames
+
+    // Statistics
+    HeadroomMonitor Monitor;               // Render load and underruns
+    std::atomic<sU64> Played;              // Frames handed to the sink (consumer)
+
+    // Render thread main loop
+    void RenderLoop();
+
+    // Render one block into the ring; returns false once the source ended
+    sBool RenderBlock();
+
+public:
+    StreamOutput();
+    ~StreamOutput();
+
+    // Set up ringframes of buffering, rendered blockframes at a time;
+    // the source ends after maxframes frames
+    sBool Open(sInt rate, sInt ringframes, sInt blockframes, StreamRenderFunc func, void *parm,
+               sU64 maxframes);
+
+    // Whether calls to the source are timed (default true); turn off for
+    // a source whose real renderer records into GetMonitor() itself
+    void SetTimed(sBool timed);
+
+    // Prefill the ring and start the render thread
+    void Start();
+
+    // Stop the render thread
+    void Stop();
+
+    // Realtime consumer: copy frames out, padding with silence (counted
+    // as an underrun unless the source has ended)
+    void Pull(sF32 *buf, sInt frames);
+
+    // Non-realtime consumer: wait until frames are available
+    // Returns the number of frames read, less only at the end of the source
+    sInt PullWait(sF32 *buf, sInt frames);
+
+    // Returns true once the source has ended and everything was pulled
+    sBool IsDone() const;
+
+    // Output sample rate
+    sInt GetRate() const;
+
+    // Frames per render call
+    sInt GetBlockFrames() const;
+
+    // Statistics
+    sU64 GetPlayedFrames() const;
+    sU64 GetUnderruns() const;
+    sU64 GetUnderrunFrames() const;
+
+    // Average and peak seconds spent rendering one block
+    void GetRenderCost(sF64 &avg, sF64 &peak) const;
+
+    // Output underflow reported by the audio device (callback safe)
+    void AddDeviceUnderflow();
+
+    // Render load and underrun monitor (readable while playing)
+    const HeadroomMonitor &GetMonitor() const;
+    HeadroomMonitor &GetMonitor();
+};
+
+#endif // STREAMOUT_H
@@ -0,0 +1,174 @@
+// =================== Work-Stealing Thread Pool Implementation ===================
+
+#include "threadpool.h"
+
+// Pool and worker index of the current thread (-1 = not a worker)
+static thread_local ThreadPool *CurPool = 0;
+static thread_local sInt CurWorker = -1;
+
+// =================== ThreadPool Constructor ===================
+ThreadPool::ThreadPool(sInt threads)
+    : Queued(0), NextQueue(0), Quit(0)
+{
+    ThreadCount = threads > 0 ? threads : CoreCount();
+    Queues = new Queue[ThreadCount];
+    for (sInt i = 0; i < ThreadCount; i++)
+        sZeroMem(&Queues[i].Stats, sizeof(WorkerStats));
+
+    Threads = new std::thread[ThreadCount];
+    for (sInt i = 0; i < ThreadCount; i++)
+        Threads[i] = std::thread(&ThreadPool::WorkerLoop, this, i);
+}
+
+// =================== ThreadPool Destructor ===================
+// Finishes all queued tasks before the workers exit
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(SleepLock);
+        Quit = 1;
+    }
+    Wake.notify_all();
+
+    for (sInt i = 0; i < ThreadCount; i++)
+        Threads[i].join();
+
+    delete[] Threads;
+    delete[] Queues;
+}
+
+// =================== ThreadPool::Submit ===================
+void ThreadPool::Submit(TaskFunc func, void *parm, Group *group)
+{
+    Task task = { func, parm, group };
+    if (group)
+        group->Pending++;
+
+    // Workers push to their own queue, everyone else round robin
+    sInt q = (CurPool == this) ? CurWorker : sInt(sU32(NextQueue++) % ThreadCount);
+    {
+        std::lock_guard<std::mutex> lock(Queues[q].Lock);
+        Queues[q].Tasks.push_back(task);
+    }
+    Queued++;
+
+    {
+        std::lock_guard<std::mutex> lock(SleepLock);
+    }
+    Wake.notify_one();
+}
+
+// =================== ThreadPool::Fetch ===================
+// Newest task from our own queue first (cache warm), then steal the
+// oldest task from the other queues
+sBool ThreadPool::Fetch(sInt self, Task &task)
+{
+    if (Queued <= 0)
+        return 0;
+
+    if (self >= 0)
+    {
+        Queue &own = Queues[self];
+        std::lock_guard<std::mutex> lock(own.Lock);
+        if (!own.Tasks.empty())
+        {
+            task = own.Tasks.back();
+            own.Tasks.pop_back();
+            Queued--;
+            return 1;
+        }
+    }
+
+    for (sInt i = 1; i <= ThreadCount; i++)
+    {
+        sInt victim = (self + i + ThreadCount) % ThreadCount;
+        if (victim == self)
+            continue;
+
+        Queue &q = Queues[victim];
+        std::lock_guard<std::mutex> lock(q.Lock);
+        if (!q.Tasks.empty())
+        {
+            task = q.Tasks.front();
+            q.Tasks.pop_front();
+            Queued--;
+            if (self >= 0)
+                Queues[self].Stats.Steals++;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// =================== ThreadPool::RunOne ===================
+sBool ThreadPool::RunOne(sInt self)
+{
+    Task task;
+    if (!Fetch(self, task))
+        return 0;
+
+    task.Func(task.Parm, self);
+    if (self >= 0)
+        Queues[self].Stats.Tasks++;
+
+    // Last task of a group done: wake up whoever waits for it
+    if (task.Grp && --task.Grp->Pending == 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(SleepLock);
+        }
+        Wake.notify_all();
+    }
+    return 1;
+}
+
+// =================== ThreadPool::WorkerLoop ===================
+void ThreadPool::WorkerLoop(sInt self)
+{
+    CurPool = this;
+    CurWorker = self;
+
+    for (;;)
+    {
+        if (RunOne(self))
+            continue;
+
+        std::unique_lock<std::mutex> lock(SleepLock);
+        Wake.wait(lock, [this] { return Quit || Queued > 0; });
+        if (Quit && Queued <= 0)
+            break;
+    }
+}
+
+// =================== ThreadPool::Wait ===================
+// Workers keep executing tasks while they wait (so nested waits cannot
+// deadlock), other threads just sleep until the group is done
+void ThreadPool::Wait(Group &group)
+{
+    sInt self = (CurPool == this) ? CurWorker : -1;
+
+    while (group.Pending > 0)
+    {
+        if (self >= 0 && RunOne(self))
+            continue;
+
+        std::unique_lock<std::mutex> lock(SleepLock);
+        Wake.wait(lock, [this, &group, self] { return group.Pending <= 0 || (self >= 0 && Queued > 0); });
+    }
+}
+
+// =================== ThreadPool Accessors ===================
+sInt ThreadPool::GetThreadCount() const
+{
+    return ThreadCount;
+}
+
+const ThreadPool::WorkerStats &ThreadPool::GetStats(sInt worker) const
+{
+    return Queues[worker].Stats;
+}
+
+sInt ThreadPool::CoreCount()
+{
+    return sMax<sInt>(std::thread::hardware_concurrency(), 1);
+}
@@ -0,0 +1,95 @@
+// =================== Work-Stealing Thread Pool ===================
+// Runs independent tasks on one worker thread per CPU core
+// Every worker owns a task queue; idle workers steal from the others
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "types.h"
+
+// =================== ThreadPool Class ===================
+class ThreadPool
+{
+public:
+    // Task entry point: parm is the submitted pointer, worker the index
+    // of the executing worker thread
+    typedef void (*TaskFunc)(void *parm, sInt worker);
+
+    // =================== Task Group ===================
+    // Counts outstanding tasks of one submitter so it can wait for them
+    struct Group
+    {
+        std::atomic<sInt> Pending;
+        Group() : Pending(0) {}
+    };
+
+    // Per-worker statistics
+    struct WorkerStats
+    {
+        sU64 Tasks;                        // Tasks executed
+        sU64 Steals;                       // Tasks taken from another worker's queue
+    };
+
+private:
+    struct Task
+    {
+        TaskFunc Func;
+        void *Parm;
+        Group *Grp;
+    };
+
+    // One queue per worker: owner pops at the back, thieves at the front
+    struct Queue
+    {
+        std::mutex Lock;
+        std::deque<Task> Tasks;
+        WorkerStats Stats;
+    };
+
+    sInt ThreadCount;                      // Number of worker threads
+    Queue *Queues;                         // Task queues (one per worker)
+    std::thread *Threads;                  // Worker threads
+    std::atomic<sInt> Queued;              // Tasks waiting in any queue
+    std::atomic<sInt> NextQueue;           // Round robin target for outside submits
+    std::atomic<sBool> Quit;               // Shut down workers
+
+    std::mutex SleepLock;                  // Guards idle waiting
+    std::condition_variable Wake;          // Signals new tasks / completed groups
+
+    // Pop a task from our own queue or steal one; returns false if none
+    sBool Fetch(sInt self, Task &task);
+
+    // Execute one task if any is available
+    sBool RunOne(sInt self);
+
+    // Worker thread main loop
+    void WorkerLoop(sInt self);
+
+public:
+    // threads: number of workers, 0 = one per CPU core
+    ThreadPool(sInt threads = 0);
+    ~ThreadPool();
+
+    // Queue a task; group (optional) is counted until the task has run
+    void Submit(TaskFunc func, void *parm, Group *group = 0);
+
+    // Wait until all tasks of a group have run
+    // Called from a worker, the worker keeps running queued tasks meanwhile
+    void Wait(Group &group);
+
+    // Number of worker threads
+    sInt GetThreadCount() const;
+
+    // Statistics of one worker (not synchronized, read after Wait())
+    const WorkerStats &GetStats(sInt worker) const;
+
+    // Number of CPU cores available to this process
+    static sInt CoreCount();
+};
+
+#endif // THREADPOOL_H
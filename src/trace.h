@@ -0,0 +1,43 @@
+// =================== Static Tracepoints ===================
+// USDT probes (provider "tinymod") at the sequencer and render block
+// boundaries, for correlating glitches with system events in perf or
+// bpftrace on an unmodified binary:
+//
+//   tinymod:tick          pos, row, tick, speed    ModPlayer::Tick, every tick
+//   tinymod:row           pos, row, pattern        ModPlayer::Tick, first tick of a row
+//   tinymod:position      pos, pattern             ModPlayer::Tick, first row at a new position
+//   tinymod:calc          writepos, samples, generate
+//                                                  Paula::Calc, voice refill of the ring
+//   tinymod:render_start  frames                   Paula::Render, block start
+//   tinymod:render_end    frames                   Paula::Render, block end
+//
+// A probe is a single nop in the code plus an ELF note describing where
+// its arguments live, so it costs nothing until a tracer attaches.
+// The probes are built in when <sys/sdt.h> is available (systemtap-sdt-dev
+// or similar); build with -DTINYMOD_TRACE=0 to leave them out anyway.
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "config.h"
+
+#if TINYMOD_TRACE && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define TRACE_SDT
+#endif
+#endif
+
+#ifdef TRACE_SDT
+#define TRACE_PROBE1(name, a)          DTRACE_PROBE1(tinymod, name, a)
+#define TRACE_PROBE2(name, a, b)       DTRACE_PROBE2(tinymod, name, a, b)
+#define TRACE_PROBE3(name, a, b, c)    DTRACE_PROBE3(tinymod, name, a, b, c)
+#define TRACE_PROBE4(name, a, b, c, d) DTRACE_PROBE4(tinymod, name, a, b, c, d)
+#else
+#define TRACE_PROBE1(name, a)          ((void)0)
+#define TRACE_PROBE2(name, a, b)       ((void)0)
+#define TRACE_PROBE3(name, a, b, c)    ((void)0)
+#define TRACE_PROBE4(name, a, b, c, d) ((void)0)
+#endif
+
+#endif // TRACE_H
@@ -8,6 +8,7 @@
 #include <math.h>        // Mathematical operations (C standard library)
 #include <string.h>      // String handling (C standard library)
 #include <cstdint>       // C++ fixed size integer types
+#include <time.h>        // Monotonic clock (POSIX)
 
 // =================== Type Definitions ===================
 // Signed integer types
@@ -48,6 +49,12 @@ inline void sZeroMem(void *dest, sInt size)
     memset(dest, 0, size);
 }
 
+// Copy a memory block (non-overlapping)
+inline void sCopyMem(void *dest, const void *src, sInt size)
+{
+    memcpy(dest, src, size);
+}
+
 // =================== Math Utilities ===================
 // Min: return smallest of two values
 template <typename T> inline T sMin(const T a, const T b)
@@ -134,6 +141,15 @@ inline sF32 sFHamming(sF32 x)
     return (x > -1 && x < 1) ? sSqr(sFCos(x * sFPi / 2)) : 0;
 }
 
+// =================== Timing Utilities ===================
+// Monotonic wall clock time in seconds
+inline sF64 sGetTime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return sF64(ts.tv_sec) + sF64(ts.tv_nsec) * 1e-9;
+}
+
 // =================== Endian Utilities ===================
 // Swap endianness of 16-bit value (big-endian <-> little-endian)
 inline void sSwapEndian(sU16 &v)
@@ -141,6 +157,13 @@ inline void sSwapEndian(sU16 &v)
     v = ((v & 0xff) << 8) | (v >> 8);
 }
 
+// =================== Calling Conventions ===================
+// Win32 calling convention qualifiers are not needed elsewhere
+#ifndef _WIN32
+#define __stdcall
+#define __cdecl
+#endif
+
 // Compiler pragmas for optimization (optional)
 // #pragma intrinsic(memset, sqrt, sin, cos, atan, powf)
 
@@ -0,0 +1,354 @@
+// =================== Golden Output Verification Implementation ===================
+
+#include "verify.h"
+#include "config.h"
+#include "paula.h"
+#include "modplayer.h"
+#include "module.h"
+#include "render.h"
+#include "pcm.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// =================== Helpers ===================
+
+// 64 bit FNV-1a hash of the raw float samples (same as the batch hash)
+static sU64 sample_hash(const sF32 *buf, sInt count)
+{
+    const sU8 *bytes = (const sU8 *)buf;
+    sU64 hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < sizeof(sF32) * size_t(count); i++)
+        hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+    return hash;
+}
+
+// File name without directories (golden entries do not depend on paths)
+static const char *base_name(const char *path)
+{
+    const char *slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+// =================== Engines ===================
+// Each engine renders the first frames of a module from the start
+// (looping forever, no fade) into out as interleaved stereo floats
+// Returns false if it could not render all frames
+
+typedef sBool (*VerifyEngine)(const Module *mod, sF32 *out, sInt frames);
+
+// Reference: serial Paula, ModPlayer::Render in offline render blocks
+static sBool engine_reference(const Module *mod, sF32 *out, sInt frames)
+{
+    Paula p;
+    ModPlayer player(&p, mod);
+    for (sInt done = 0; done < frames; done += RENDER_BLOCK_SIZE)
+    {
+        sInt n = sMin(RENDER_BLOCK_SIZE, frames - done);
+        if (player.Render(out + 2 * done, n) != sU32(n))
+            return 0;
+    }
+    return 1;
+}
+
+// Odd and tiny block sizes (refill points inside and across blocks)
+static sBool engine_blocks(const Module *mod, sF32 *out, sInt frames)
+{
+    static const sInt sizes[] = { 1, 7, 333, 64, 4097, 2 };
+    Paula p;
+    ModPlayer player(&p, mod);
+    for (sInt done = 0, i = 0; done < frames; i++)
+    {
+        sInt n = sMin(sizes[i % 6], frames - done);
+        if (player.Render(out + 2 * done, n) != sU32(n))
+            return 0;
+        done += n;
+    }
+    return 1;
+}
+
+// Restore: second half from a player positioned by pre-scan plus warm-up
+static sBool engine_prescan(const Module *mod, sF32 *out, sInt frames)
+{
+    sInt half = frames / 2;
+    sInt snap = sMax(half - PARALLEL_WARMUP, 0);
+
+    Paula p0, p1;
+    ModPlayer first(&p0, mod), second(&p1, mod);
+    if (first.Render(out, half) != sU32(half))
+        return 0;
+    if (second.Advance(snap, 0) != sU32(snap) || second.Advance(half - snap, 1) != sU32(half - snap))
+        return 0;
+    return second.Render(out + 2 * half, frames - half) == sU32(frames - half);
+}
+
+// Engines built on render_module(), selected by render options
+struct CollectState
+{
+    sF32 *Out;
+    sInt Frames;
+    sInt Done;
+};
+
+static sBool collect_block(void *parm, const sF32 *buf, sInt frames)
+{
+    CollectState *s = (CollectState *)parm;
+    sInt n = sMin(frames, s->Frames - s->Done);
+    sCopyMem(s->Out + 2 * s->Done, buf, sizeof(sF32) * 2 * n);
+    s->Done += n;
+    return 1;
+}
+
+static sBool render_with(const Module *mod, sF32 *out, sInt frames, const RenderOptions &opt)
+{
+    CollectState s = { out, frames, 0 };
+    RenderResult res;
+    if (!render_module(mod, opt, collect_block, &s, res))
+        return 0;
+    return s.Done == frames;
+}
+
+static void excerpt_options(RenderOptions &opt, sInt frames)
+{
+    render_defaults(opt);
+    opt.Loops = 0;
+    opt.MaxSeconds = sF32(frames) / OUTRATE;
+}
+
+// Timeline split into chunks on a thread pool
+static sBool engine_threads(const Module *mod, sF32 *out, sInt frames)
+{
+    RenderOptions opt;
+    excerpt_options(opt, frames);
+    opt.Threads = 2;
+    return render_with(mod, out, frames, opt);
+}
+
+// FIR of each block shared by a thread pool
+static sBool engine_fir_threads(const Module *mod, sF32 *out, sInt frames)
+{
+    RenderOptions opt;
+    excerpt_options(opt, frames);
+    opt.FIRThreads = 2;
+    return render_with(mod, out, frames, opt);
+}
+
+// Voices on a producer thread, FIR on the caller
+static sBool engine_pipeline(const Module *mod, sF32 *out, sInt frames)
+{
+    RenderOptions opt;
+    excerpt_options(opt, frames);
+    opt.Pipelined = 1;
+    return render_with(mod, out, frames, opt);
+}
+
+// Fused integer output, decoded back to float
+static sBool render_s16(const Module *mod, sF32 *out, sInt frames, sBool dithered)
+{
+    Paula p;
+    ModPlayer player(&p, mod);
+    PcmDither dither;
+    pcm_dither_init(dither, dithered);
+
+    sS16 *pcm = (sS16 *)malloc(sizeof(sS16) * 2 * RENDER_BLOCK_SIZE);
+    sBool ok = 1;
+    for (sInt done = 0; ok && done < frames; done += RENDER_BLOCK_SIZE)
+    {
+        sInt n = sMin(RENDER_BLOCK_SIZE, frames - done);
+        ok = player.RenderPCM(pcm, n, FORMAT_S16, &dither) == sU32(n);
+        for (sInt i = 0; i < 2 * n; i++)
+            out[2 * done + i] = sF32(pcm[i]) / 32767.0f;
+    }
+    free(pcm);
+    return ok;
+}
+
+static sBool engine_s16(const Module *mod, sF32 *out, sInt frames)
+{
+    return render_s16(mod, out, frames, 0);
+}
+
+static sBool engine_s16_dither(const Module *mod, sF32 *out, sInt frames)
+{
+    return render_s16(mod, out, frames, 1);
+}
+
+// =================== Checks ===================
+// MinSNR == 0 requires bit-identical output
+struct VerifyCheck
+{
+    const char *Name;
+    VerifyEngine Func;
+    sF64 MinSNR;                           // Lowest acceptable SNR in dB
+    sF64 MaxPeak;                          // Largest acceptable sample error
+};
+
+static const VerifyCheck Checks[] = {
+    { "blocks",      engine_blocks,      0, 0 },
+    { "prescan",     engine_prescan,     0, 0 },
+    { "threads",     engine_threads,     0, 0 },
+    { "fir-threads", engine_fir_threads, 0, 0 },
+    { "pipeline",    engine_pipeline,    0, 0 },
+    { "s16",         engine_s16,         70, 0.51 / 32767.0 },   // Rounding only
+    { "s16-dither",  engine_s16_dither,  65, 1.51 / 32767.0 },   // Rounding plus +-1 LSB dither
+};
+
+// Difference statistics of a rendered excerpt against the reference
+struct Difference
+{
+    sInt Mismatches;                       // Samples that are not bit-identical
+    sF64 Peak;                             // Largest absolute error
+    sF64 SNR;                              // Signal to error ratio in dB (HUGE_VAL = identical)
+};
+
+static void compare(const sF32 *ref, const sF32 *test, sInt count, Difference &d)
+{
+    sF64 sig = 0, err = 0;
+    d.Mismatches = 0;
+    d.Peak = 0;
+    for (sInt i = 0; i < count; i++)
+    {
+        if (memcmp(&ref[i], &test[i], sizeof(sF32)))
+            d.Mismatches++;
+        sF64 e = sF64(test[i]) - sF64(ref[i]);
+        sig += sF64(ref[i]) * ref[i];
+        err += e * e;
+        d.Peak = sMax(d.Peak, fabs(e));
+    }
+    d.SNR = err > 0 ? 10.0 * log10(sig / err) : HUGE_VAL;
+}
+
+// =================== Golden File ===================
+// One line per excerpt: "<module file name> <seconds> <hash>"
+
+static sBool golden_find(const char *golden, const char *name, sF32 seconds, sU64 &hash)
+{
+    FILE *fh = golden ? fopen(golden, "r") : NULL;
+    if (!fh)
+        return 0;
+
+    char line[1024], gname[512];
+    sF32 gseconds;
+    unsigned long long ghash;
+    sBool found = 0;
+    while (!found && fgets(line, sizeof(line), fh))
+    {
+        if (line[0] == '#')
+            continue;
+        if (sscanf(line, "%511s %f %llx", gname, &gseconds, &ghash) == 3 && !strcmp(gname, name) &&
+            gseconds == seconds)
+        {
+            hash = ghash;
+            found = 1;
+        }
+    }
+    fclose(fh);
+    return found;
+}
+
+// =================== verify_run ===================
+sInt verify_run(const char **files, sInt count, const VerifyOptions &opt)
+{
+    sInt frames = sInt(opt.Seconds * OUTRATE);
+    sF32 *ref = (sF32 *)malloc(sizeof(sF32) * 2 * frames);
+    sF32 *test = (sF32 *)malloc(sizeof(sF32) * 2 * frames);
+    sInt failed = 0, passed = 0;
+
+    FILE *update = NULL;
+    if (opt.Update)
+    {
+        update = fopen(opt.Golden, "w");
+        if (!update)
+        {
+            perror(opt.Golden);
+            free(ref);
+            free(test);
+            return 1;
+        }
+        fprintf(update, "# TinyMOD golden output: FNV-1a 64 hash of the raw f32 stereo excerpt\n");
+        fprintf(update, "# (reference path, %d Hz, looping, no fade); regenerate with --update-golden\n",
+                OUTRATE);
+    }
+
+    for (sInt f = 0; f < count; f++)
+    {
+        const char *name = base_name(files[f]);
+        const Module *mod = Module::Load(files[f]);
+        if (!mod)
+        {
+            printf("FAIL  %-24s %-12s cannot load\n", name, "reference");
+            failed++;
+            continue;
+        }
+
+        // === Reference and Golden Hash ===
+        if (!engine_reference(mod, ref, frames))
+        {
+            printf("FAIL  %-24s %-12s song shorter than %.1f seconds\n", name, "reference", opt.Seconds);
+            failed++;
+            mod->Release();
+            continue;
+        }
+
+        sU64 hash = sample_hash(ref, 2 * frames), golden;
+        if (update)
+        {
+            fprintf(update, "%s %g %016llx\n", name, opt.Seconds, (unsigned long long)hash);
+            printf("SAVE  %-24s %-12s %016llx\n", name, "reference", (unsigned long long)hash);
+        }
+        else if (!golden_find(opt.Golden, name, opt.Seconds, golden))
+            printf("SKIP  %-24s %-12s no golden hash for %g seconds\n", name, "reference", opt.Seconds);
+        else if (golden != hash)
+        {
+            printf("FAIL  %-24s %-12s hash %016llx, golden %016llx\n", name, "reference",
+                   (unsigned long long)hash, (unsigned long long)golden);
+            failed++;
+        }
+        else
+        {
+            printf("PASS  %-24s %-12s matches golden hash\n", name, "reference");
+            passed++;
+        }
+
+        // === Alternative Engines ===
+        for (size_t c = 0; c < sizeof(Checks) / sizeof(Checks[0]); c++)
+        {
+            const VerifyCheck &check = Checks[c];
+            sZeroMem(test, sizeof(sF32) * 2 * frames);
+            if (!check.Func(mod, test, frames))
+            {
+                printf("FAIL  %-24s %-12s rendered too few frames\n", name, check.Name);
+                failed++;
+                continue;
+            }
+
+            Difference d;
+            compare(ref, test, 2 * frames, d);
+
+            sBool ok = check.MinSNR > 0 ? d.SNR >= check.MinSNR && d.Peak <= check.MaxPeak : !d.Mismatches;
+            if (!d.Mismatches)
+                printf("%s  %-24s %-12s bit-exact\n", ok ? "PASS" : "FAIL", name, check.Name);
+            else
+                printf("%s  %-24s %-12s %d samples differ, peak error %.3g, SNR %.1f dB\n", ok ? "PASS" : "FAIL",
+                       name, check.Name, d.Mismatches, d.Peak, d.SNR);
+            if (ok)
+                passed++;
+            else
+                failed++;
+        }
+
+        mod->Release();
+    }
+
+    if (update && fclose(update) != 0)
+    {
+        perror(opt.Golden);
+        failed++;
+    }
+
+    printf("\n%d passed, %d failed\n", passed, failed);
+    free(ref);
+    free(test);
+    return failed;
+}
@@ -0,0 +1,27 @@
+// =================== Golden Output Verification ===================
+// Regression checks for the alternative render paths
+// A fixed-length excerpt of each module is rendered through the reference
+// path (ModPlayer::Render on a serial Paula, fixed block size) and its
+// hash compared with a stored golden hash. Every other engine or kernel
+// then renders the same excerpt and is compared with the reference:
+// bit-exactly where it promises identical output, otherwise against
+// SNR and peak error limits.
+
+#ifndef VERIFY_H
+#define VERIFY_H
+
+#include "types.h"
+
+// =================== Verify Options ===================
+struct VerifyOptions
+{
+    sF32 Seconds;                          // Excerpt length per module
+    const char *Golden;                    // Golden hash file (NULL = no golden check)
+    sBool Update;                          // Write the golden file instead of checking it
+};
+
+// Verify all engines on the given modules, printing one line per check
+// Returns the number of failed checks (missing golden hashes do not fail)
+sInt verify_run(const char **files, sInt count, const VerifyOptions &opt);
+
+#endif // VERIFY_H
@@ -0,0 +1,159 @@
+// =================== WAV File Writer Implementation ===================
+// Sample format conversion and RIFF/WAVE header handling
+
+#include "wavwriter.h"
+#include "config.h"
+#include <stdlib.h>
+
+// Store little-endian values into a byte buffer
+static void put_le16(sU8 *p, sU32 v)
+{
+    p[0] = sU8(v);
+    p[1] = sU8(v >> 8);
+}
+
+static void put_le32(sU8 *p, sU32 v)
+{
+    p[0] = sU8(v);
+    p[1] = sU8(v >> 8);
+    p[2] = sU8(v >> 16);
+    p[3] = sU8(v >> 24);
+}
+
+// =================== WavWriter Constructor/Destructor ===================
+WavWriter::WavWriter()
+    : File(0), Format(FORMAT_F32), Channels(2), Rate(OUTRATE), Raw(0), DataBytes(0),
+      Conv(0), ConvFrames(0)
+{
+    pcm_dither_init(Dither, 0);
+}
+
+WavWriter::~WavWriter()
+{
+    free(Conv);
+}
+
+// =================== WavWriter::WriteHeader ===================
+// Standard 44 byte header: RIFF chunk, 16 byte fmt chunk, data chunk.
+// 24 and 32 bit integer PCM use the 68 byte WAVE_FORMAT_EXTENSIBLE
+// layout instead (40 byte fmt chunk), since readers may reject or
+// misinterpret plain PCM above 16 bits.
+sBool WavWriter::WriteHeader(sU64 databytes)
+{
+    // KSDATAFORMAT_SUBTYPE_PCM, 00000001-0000-0010-8000-00aa00389b71
+    static const sU8 pcmguid[16] =
+    {
+        0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00,
+        0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71
+    };
+
+    sU8 h[68];
+    sInt bytes = format_bytes(Format);
+    sBool ext = Format == FORMAT_S24 || Format == FORMAT_S32;
+    sInt fmtsize = ext ? 40 : 16;
+    sInt size = 28 + fmtsize;              // Header bytes in front of the samples
+    sU32 over = sU32(size - 8);            // RIFF chunk size minus data size
+
+    // Sizes beyond 4GB (or unknown sizes on pipes) are written as maximum
+    sU32 datasize = databytes > 0xffffffffULL - over ? 0xffffffffUL - over : sU32(databytes);
+
+    memcpy(h, "RIFF", 4);
+    put_le32(h + 4, datasize + over);
+    memcpy(h + 8, "WAVE", 4);
+    memcpy(h + 12, "fmt ", 4);
+    put_le32(h + 16, fmtsize);
+    put_le16(h + 20, ext ? 0xfffe : Format == FORMAT_F32 ? 3 : 1); // Extensible, IEEE float or PCM
+    put_le16(h + 22, Channels);
+    put_le32(h + 24, Rate);
+    put_le32(h + 28, Rate * Channels * bytes);        // Byte rate
+    put_le16(h + 32, Channels * bytes);               // Block align
+    put_le16(h + 34, 8 * bytes);                      // Bits per sample
+    if (ext)
+    {
+        put_le16(h + 36, 22);                         // Extension size
+        put_le16(h + 38, 8 * bytes);                  // Valid bits per sample
+        put_le32(h + 40, Channels == 2 ? 3 : 0);      // Front left + right
+        memcpy(h + 44, pcmguid, 16);
+    }
+    memcpy(h + size - 8, "data", 4);
+    put_le32(h + size - 4, datasize);
+
+    return fwrite(h, size, 1, File) == 1;
+}
+
+// =================== WavWriter::Open ===================
+sBool WavWriter::Open(FILE *file, sInt format, sInt channels, sInt rate, sBool raw)
+{
+    File = file;
+    Format = format;
+    Channels = channels;
+    Rate = rate;
+    Raw = raw;
+    DataBytes = 0;
+
+    // Header with open-ended sizes, patched in Close() if possible
+    if (!Raw)
+        return WriteHeader(~0ULL);
+    return 1;
+}
+
+// =================== WavWriter::SetDither ===================
+void WavWriter::SetDither(sBool enabled)
+{
+    pcm_dither_init(Dither, enabled);
+}
+
+// =================== WavWriter::Write ===================
+// Convert float samples to the output format and write them
+sBool WavWriter::Write(const sF32 *buf, sInt frames)
+{
+    // Native float: write straight through (little-endian hosts)
+    if (Format == FORMAT_F32)
+        return WritePCM(buf, frames);
+
+    // Grow conversion buffer if needed
+    if (frames > ConvFrames)
+    {
+        sU8 *conv = (sU8 *)realloc(Conv, frames * Channels * format_bytes(Format));
+        if (!conv)
+            return 0;
+        Conv = conv;
+        ConvFrames = frames;
+    }
+
+    pcm_convert(buf, Conv, frames * Channels, Format, &Dither);
+    return WritePCM(Conv, frames);
+}
+
+// =================== WavWriter::WritePCM ===================
+sBool WavWriter::WritePCM(const void *buf, sInt frames)
+{
+    size_t bytes = size_t(frames) * Channels * format_bytes(Format);
+    if (fwrite(buf, 1, bytes, File) != bytes)
+        return 0;
+    DataBytes += bytes;
+    return 1;
+}
+
+// =================== WavWriter::Close ===================
+sBool WavWriter::Close()
+{
+    sBool ok = 1;
+
+    // Patch the header with the real sizes if we can seek back
+    if (!Raw && fseek(File, 0, SEEK_SET) == 0)
+    {
+        ok = WriteHeader(DataBytes);
+        fseek(File, 0, SEEK_END);
+    }
+
+    if (fflush(File) != 0)
+        ok = 0;
+    return ok;
+}
+
+// =================== WavWriter::GetFrames ===================
+sU64 WavWriter::GetFrames() const
+{
+    return DataBytes / (format_bytes(Format) * Channels);
+}
@@ -0,0 +1,55 @@
+// =================== WAV File Writer ===================
+// Streams interleaved stereo audio to a WAV or raw PCM file
+// Works on pipes too: the header is patched at the end when the
+// output is seekable, otherwise it is written with open-ended sizes
+
+#ifndef WAVWRITER_H
+#define WAVWRITER_H
+
+#include <stdio.h>
+#include "types.h"
+#include "pcm.h"
+
+// =================== WavWriter Class ===================
+class WavWriter
+{
+private:
+    FILE *File;                            // Output file (not owned)
+    sInt Format;                           // Sample format (SampleFormat)
+    sInt Channels;                         // Number of interleaved channels
+    sInt Rate;                             // Sample rate in Hz
+    sBool Raw;                             // Write headerless PCM
+    sU64 DataBytes;                        // Bytes of sample data written so far
+
+    sU8 *Conv;                             // Conversion scratch buffer
+    sInt ConvFrames;                       // Capacity of scratch buffer in frames
+    PcmDither Dither;                      // Dither state for integer formats
+
+    // Write the RIFF/WAVE header for the given data size
+    sBool WriteHeader(sU64 databytes);
+
+public:
+    WavWriter();
+    ~WavWriter();
+
+    // Start a new stream on an already opened file
+    // raw: write plain PCM without a WAV header
+    sBool Open(FILE *file, sInt format, sInt channels, sInt rate, sBool raw);
+
+    // Enable TPDF dither for integer formats (off by default)
+    void SetDither(sBool enabled);
+
+    // Convert and write interleaved float frames
+    sBool Write(const sF32 *buf, sInt frames);
+
+    // Write interleaved frames already converted to the stream format
+    sBool WritePCM(const void *buf, sInt frames);
+
+    // Finish the stream, patching the header sizes if the file is seekable
+    sBool Close();
+
+    // Number of frames written so far
+    sU64 GetFrames() const;
+};
+
+#endif // WAVWRITER_H
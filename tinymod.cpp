@@ -66,6 +66,7 @@
 #include <unistd.h>									// (unix standard)
 #include <fcntl.h>									// (file control options) - used by open()
 #include <sys/stat.h>								// needed by stat function (get file status)
+#include <sys/mman.h>								// memory mapped files (mmap)
 #include <cstdint>									// defines set of integeral types
 #include <cstdio>									// defines set of C standard I/O types
 #include "portaudio.h"								// port audio
@@ -110,22 +111,31 @@ OPTIONS\n\
 // **********************
 // **  load MOD file   **
 // **********************
-    static sU8 mod[4 * 1024 * 1024];				// 4MB unsigned character array to hold MOD file
-
-    FILE* fh = fopen(filename, "rb");
-    if (!fh) {
-        perror("fopen");
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1) {
+        perror("open");
         exit(EXIT_FAILURE);
     }
 
     struct stat sb;
-    if (stat(filename, &sb) == -1) {
-        perror("stat");
+    if (fstat(fd, &sb) == -1) {
+        perror("fstat");
         exit(EXIT_FAILURE);
     }
 
-    fread(mod, sb.st_size, 1, fh);
-    fclose(fh);
+    // reserve zeroed address space (at least 4MB, like the old static array) so
+    // samples running past the end of a truncated file read silence, then map
+    // the file over its start: pages are read on demand and shared through the
+    // page cache, and the in-place header byte swapping only copies the pages
+    // it writes to (MAP_PRIVATE)
+    size_t maplen = sb.st_size + 4 * 1024 * 1024;
+    sU8 *mod = (sU8 *)mmap(NULL, maplen, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mod == MAP_FAILED ||
+        mmap(mod, sb.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        perror("mmap");
+        exit(EXIT_FAILURE);
+    }
+    close(fd);
 
 // **********************
 // ** port audio setup **